@@ -0,0 +1,621 @@
+//@	{"target":{"name":"joppbench.o"}}
+
+#include "lib/parser.hpp"
+#include "lib/fast_parser.hpp"
+#include "lib/stream_parser.hpp"
+#include "lib/ndjson.hpp"
+#include "lib/parallel_parser.hpp"
+#include "lib/from_json.hpp"
+#include "lib/filtered_parser.hpp"
+#include "lib/serializer.hpp"
+
+#include <chrono>
+#include <random>
+#include <cstdio>
+#include <string_view>
+#include <span>
+#include <vector>
+#include <memory_resource>
+
+namespace
+{
+	struct payload
+	{
+		double value{};
+		std::vector<std::string> tags;
+	};
+
+	struct message
+	{
+		size_t seq{};
+		std::string topic;
+		payload data;
+	};
+}
+
+template<>
+struct jopp::object_converter<payload>
+{
+	static constexpr std::tuple fields{
+		jopp::field{"value", &payload::value},
+		jopp::field{"tags", &payload::tags}
+	};
+};
+
+template<>
+struct jopp::object_converter<message>
+{
+	static constexpr std::tuple fields{
+		jopp::field{"seq", &message::seq},
+		jopp::field{"topic", &message::topic},
+		jopp::field{"payload", &message::data}
+	};
+};
+
+namespace
+{
+	std::string make_document(size_t min_size, bool string_heavy)
+	{
+		std::mt19937 rng;
+		std::string ret{"[\n"};
+		size_t k = 0;
+		while(std::size(ret) < min_size)
+		{
+			if(k != 0)
+			{ ret.append(",\n"); }
+			ret.append("\t{\"id\": ").append(std::to_string(k))
+				.append(", \"enabled\": ").append(k % 3 == 0 ? "true" : "false")
+				.append(", \"parent\": null");
+			if(string_heavy)
+			{
+				ret.append(", \"description\": \"");
+				auto const length = std::uniform_int_distribution<size_t>{16, 256}(rng);
+				for(size_t l = 0; l != length; ++l)
+				{ ret += static_cast<char>(std::uniform_int_distribution{'a', 'z'}(rng)); }
+				ret.append("\\n\", \"name\": \"Item number ").append(std::to_string(k)).append("\"");
+			}
+			else
+			{
+				ret.append(", \"samples\": [");
+				for(size_t l = 0; l != 16; ++l)
+				{
+					if(l != 0)
+					{ ret.append(", "); }
+					ret.append(jopp::to_string(std::uniform_real_distribution{-1.0e3, 1.0e3}(rng)));
+				}
+				ret.append("]");
+			}
+			ret.append("}");
+			++k;
+		}
+		ret.append("\n]\n");
+		return ret;
+	}
+
+	// Calls func, which processes byte_count bytes, a number of times and reports the throughput
+	template<class Func>
+	void report_throughput(char const* name, size_t byte_count, Func&& func)
+	{
+		constexpr size_t iterations = 8;
+		auto const t0 = std::chrono::steady_clock::now();
+		for(size_t k = 0; k != iterations; ++k)
+		{ func(); }
+		auto const t1 = std::chrono::steady_clock::now();
+		auto const seconds = std::chrono::duration<double>(t1 - t0).count();
+		auto const mb_per_s = static_cast<double>(iterations*byte_count)/(seconds*1.0e6);
+		printf("%-40s %10.1f MB/s\n", name, mb_per_s);
+	}
+
+	template<class Func>
+	void report_throughput(char const* name, std::string_view data, Func&& func)
+	{ report_throughput(name, std::size(data), [data, &func]() { func(data); }); }
+
+	std::vector<std::string> make_messages(size_t count)
+	{
+		std::mt19937 rng;
+		std::vector<std::string> ret;
+		for(size_t k = 0; k != count; ++k)
+		{
+			ret.push_back(std::string{"{\"seq\": "}.append(std::to_string(k))
+				.append(", \"topic\": \"sensors/").append(std::to_string(k % 16))
+				.append("\", \"payload\": {\"value\": ")
+				.append(jopp::to_string(std::uniform_real_distribution{-1.0e3, 1.0e3}(rng)))
+				.append(", \"tags\": [\"a\", \"b\"]}}"));
+		}
+		return ret;
+	}
+
+	template<class Func>
+	void report_latency(char const* name, std::span<std::string const> messages, Func&& func)
+	{
+		auto const t0 = std::chrono::steady_clock::now();
+		for(auto const& item : messages)
+		{ func(item); }
+		auto const t1 = std::chrono::steady_clock::now();
+		auto const seconds = std::chrono::duration<double>(t1 - t0).count();
+		printf("%-40s %10.1f ns/message\n", name, seconds*1.0e9/static_cast<double>(std::size(messages)));
+	}
+
+	void check_result(jopp::parser_error_code ec)
+	{
+		if(ec != jopp::parser_error_code::completed)
+		{ throw std::runtime_error{to_string(ec)}; }
+	}
+
+	void check(bool ok, char const* what)
+	{
+		if(!ok)
+		{ throw std::runtime_error{what}; }
+	}
+
+	void parse_with_parser(std::string_view data)
+	{
+		jopp::container root;
+		jopp::parser parser{root};
+		check_result(parser.parse(data).ec);
+	}
+
+	void parse_with_unchecked_parser(std::string_view data)
+	{
+		jopp::container root;
+		jopp::basic_parser<jopp::unchecked_parser_policy> parser{root};
+		check_result(parser.parse(data).ec);
+	}
+
+	void parse_with_parser_4k_blocks(std::string_view data)
+	{
+		jopp::container root;
+		jopp::parser parser{root};
+		while(true)
+		{
+			auto const res = parser.parse(data.substr(0, 4096));
+			if(res.ec != jopp::parser_error_code::more_data_needed)
+			{
+				check_result(res.ec);
+				return;
+			}
+			data.remove_prefix(std::min(std::size(data), static_cast<size_t>(4096)));
+		}
+	}
+
+	struct value_counter
+	{
+		void on_begin_object() {}
+		void on_end_object() {}
+		void on_begin_array() {}
+		void on_end_array() {}
+		void on_key(std::string_view) {}
+		void on_string(std::string_view) { ++count; }
+		void on_number(jopp::number) { ++count; }
+		void on_boolean(jopp::boolean) { ++count; }
+		void on_null() { ++count; }
+
+		size_t count{};
+	};
+
+	void parse_with_event_parser(std::string_view data)
+	{
+		jopp::event_parser<value_counter> parser{1024};
+		check_result(parser.parse(data).ec);
+	}
+
+	void parse_with_fast_parser(std::string_view data)
+	{
+		jopp::container root;
+		jopp::fast_parser parser{root};
+		check_result(parser.parse(data).ec);
+	}
+
+	void parse_with_fast_parser_arena(std::string_view data)
+	{
+		std::pmr::monotonic_buffer_resource resource;
+		jopp::container root;
+		jopp::fast_parser parser{root, 1024, &resource};
+		check_result(parser.parse(data).ec);
+	}
+
+	void parse_with_fast_parser_reference_input(std::string_view data)
+	{
+		std::pmr::monotonic_buffer_resource resource;
+		jopp::container root;
+		jopp::fast_parser parser{root, 1024, &resource, jopp::string_storage::reference_input};
+		check_result(parser.parse(data).ec);
+	}
+
+	void parse_with_parse_parallel(std::string_view data)
+	{
+		jopp::container root;
+		check_result(jopp::parse_parallel(data, root).ec);
+	}
+
+	void bench_parse()
+	{
+		for(auto string_heavy : {true, false})
+		{
+			auto const data = make_document(32*1024*1024, string_heavy);
+			printf("# %s document, %zu bytes\n", string_heavy ? "String-heavy" : "Number-heavy", std::size(data));
+			report_throughput("parser, one block", data, parse_with_parser);
+			report_throughput("parser, unchecked policy", data, parse_with_unchecked_parser);
+			report_throughput("parser, 4 KiB blocks", data, parse_with_parser_4k_blocks);
+			report_throughput("fast_parser", data, parse_with_fast_parser);
+			report_throughput("fast_parser, monotonic arena", data, parse_with_fast_parser_arena);
+			report_throughput("fast_parser, arena, zero-copy strings", data,
+				parse_with_fast_parser_reference_input);
+			report_throughput("parse_parallel", data, parse_with_parse_parallel);
+			report_throughput("event_parser, no DOM", data, parse_with_event_parser);
+		}
+	}
+
+	void serialize_to_buffer(jopp::container const& root, bool pretty_print)
+	{
+		jopp::serializer serializer{root, pretty_print};
+		std::array<char, 65536> buffer{};
+		while(true)
+		{
+			auto const res = serializer.serialize(buffer);
+			if(res.ec == jopp::serializer_error_code::completed)
+			{ return; }
+			if(res.ec != jopp::serializer_error_code::buffer_is_full)
+			{ throw std::runtime_error{"Failed to serialize"}; }
+		}
+	}
+
+	void bench_serialize()
+	{
+		for(auto string_heavy : {true, false})
+		{
+			auto const data = make_document(32*1024*1024, string_heavy);
+			jopp::container root;
+			check_result(jopp::fast_parser{root}.parse(std::string_view{data}).ec);
+			auto const output = jopp::to_string(root, false);
+			printf("# %s document, %zu bytes\n", string_heavy ? "String-heavy" : "Number-heavy", std::size(output));
+			report_throughput("serializer, 64 KiB blocks", output, [&root](std::string_view) {
+				serialize_to_buffer(root, false);
+			});
+			report_throughput("serializer, pretty print", output, [&root](std::string_view) {
+				serialize_to_buffer(root, true);
+			});
+			report_throughput("serialized_size", output, [&root](std::string_view) {
+				check(jopp::serialized_size(root).has_value(), "Failed to compute the serialized size");
+			});
+			report_throughput("to_string", output, [&root](std::string_view) {
+				check(!jopp::to_string(root).empty(), "Failed to serialize");
+			});
+		}
+
+		{
+			// Many small, nested containers
+			jopp::array items;
+			for(size_t k = 0; k != 1024*1024; ++k)
+			{
+				jopp::array inner;
+				inner.push_back(jopp::array{});
+				inner.push_back(static_cast<jopp::number>(k % 10));
+				jopp::object obj;
+				obj.insert("a", std::move(inner));
+				obj.insert("b", jopp::object{});
+				items.push_back(std::move(obj));
+			}
+			jopp::container const root{std::move(items)};
+			auto const output = jopp::to_string(root, false);
+			printf("# Container-heavy document, %zu bytes\n", std::size(output));
+			report_throughput("serializer, 64 KiB blocks", output, [&root](std::string_view) {
+				serialize_to_buffer(root, false);
+			});
+		}
+	}
+
+	// The escape function from before it was vectorized, for comparison
+	std::optional<std::string> escape_bytewise(std::string_view val)
+	{
+		std::string ret;
+		ret.reserve(std::size(val));
+		for(auto ch : val)
+		{
+			if(jopp::char_should_be_escaped(ch))
+			{
+				auto const esc_char = jopp::get_escape_char(ch);
+				if(!esc_char.has_value())
+				{ return std::nullopt; }
+
+				ret.push_back(jopp::begin_esc_seq);
+				ret.push_back(*esc_char);
+			}
+			else
+			{ ret.push_back(ch); }
+		}
+		return ret;
+	}
+
+	void bench_escape()
+	{
+		for(size_t length : {16, 256, 4096})
+		{
+			std::mt19937 rng;
+			std::vector<std::string> strings;
+			size_t total_size = 0;
+			while(total_size < 32*1024*1024)
+			{
+				std::string str;
+				for(size_t k = 0; k != length; ++k)
+				{
+					auto const r = std::uniform_int_distribution{0, 99}(rng);
+					str += r == 0 ? '"' : (r == 1 ? '\n' : static_cast<char>('a' + r % 26));
+				}
+				total_size += std::size(str);
+				strings.push_back(std::move(str));
+			}
+
+			printf("# %zu strings of %zu bytes, 2%% escaped\n", std::size(strings), length);
+			report_throughput("escape, byte by byte", total_size, [&strings]() {
+				for(auto const& item : strings)
+				{ check(escape_bytewise(item).has_value(), "Failed to escape"); }
+			});
+			report_throughput("escape, to std::string", total_size, [&strings]() {
+				for(auto const& item : strings)
+				{ check(jopp::escape(item).has_value(), "Failed to escape"); }
+			});
+			std::vector<char> buffer(jopp::max_escaped_size(length));
+			report_throughput("escape, into buffer", total_size, [&strings, &buffer]() {
+				for(auto const& item : strings)
+				{ check(jopp::escape(item, buffer).status == jopp::escape_status::completed, "Failed to escape"); }
+			});
+		}
+	}
+
+	void bench_numbers()
+	{
+		for(auto whole : {true, false})
+		{
+			std::mt19937 rng;
+			std::vector<jopp::number> numbers(4*1024*1024);
+			std::string output;
+			for(auto& item : numbers)
+			{
+				item = whole ? static_cast<jopp::number>(std::uniform_int_distribution<int64_t>{-1000000, 1000000}(rng))
+					: std::uniform_real_distribution{-1.0e3, 1.0e3}(rng);
+				output.append(jopp::to_string(item));
+			}
+
+			printf("# %zu %s numbers, %zu bytes\n", std::size(numbers), whole ? "whole" : "fractional", std::size(output));
+			std::vector<char> buffer(std::size(numbers)*jopp::max_number_size);
+			report_throughput("std::to_chars", output, [&numbers, &buffer](std::string_view) {
+				auto ptr = std::data(buffer);
+				for(auto item : numbers)
+				{ ptr = std::to_chars(ptr, ptr + jopp::max_number_size, item).ptr; }
+				check(ptr != std::data(buffer), "Failed to write numbers");
+			});
+			report_throughput("write_number", output, [&numbers, &buffer](std::string_view) {
+				auto ptr = std::data(buffer);
+				for(auto item : numbers)
+				{ ptr = jopp::write_number(ptr, item); }
+				check(ptr != std::data(buffer), "Failed to write numbers");
+			});
+		}
+	}
+
+	// Counts what the tree allocates, so that the cost of the value layout can be compared
+	class counting_resource:public std::pmr::memory_resource
+	{
+	public:
+		size_t allocations() const
+		{ return m_allocations; }
+
+		size_t bytes() const
+		{ return m_bytes; }
+
+	private:
+		void* do_allocate(size_t bytes, size_t alignment) override
+		{
+			++m_allocations;
+			m_bytes += bytes;
+			return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+		}
+
+		void do_deallocate(void* ptr, size_t bytes, size_t alignment) override
+		{ std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment); }
+
+		bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override
+		{ return this == &other; }
+
+		size_t m_allocations{};
+		size_t m_bytes{};
+	};
+
+	void bench_memory()
+	{
+		printf("# sizeof(jopp::value) is %zu\n", sizeof(jopp::value));
+		for(auto string_heavy : {true, false})
+		{
+			auto const data = make_document(32*1024*1024, string_heavy);
+			printf("# %s document, %zu bytes\n", string_heavy ? "String-heavy" : "Number-heavy", std::size(data));
+
+			counting_resource resource;
+			jopp::container root;
+			check_result(jopp::fast_parser{root, 1024, &resource}.parse(std::string_view{data}).ec);
+			auto const input_kib = static_cast<double>(std::size(data))/1024.0;
+			printf("%-40s %10.1f per KiB of input\n", "fast_parser, allocations",
+				static_cast<double>(resource.allocations())/input_kib);
+			printf("%-40s %10.1f per KiB of input\n", "fast_parser, KiB allocated",
+				static_cast<double>(resource.bytes())/(1024.0*input_kib));
+		}
+	}
+
+	void bench_filtered()
+	{
+		for(auto string_heavy : {true, false})
+		{
+			auto const data = make_document(32*1024*1024, string_heavy);
+			printf("# %s document, %zu bytes\n", string_heavy ? "String-heavy" : "Number-heavy", std::size(data));
+			report_throughput("fast_parser, everything", data, parse_with_fast_parser);
+
+			// /* and /*/samples select whole containers
+			for(auto path : {"/*/id", "/1000/id", "/*", "/*/samples"})
+			{
+				jopp::path_filter const filter{path};
+				report_throughput((std::string{"filtered_parser, "} + path).c_str(), data, [&filter](std::string_view input) {
+					jopp::container root;
+					check_result(jopp::filtered_parser{root, filter}.parse(input).ec);
+				});
+			}
+		}
+	}
+
+	void bench_messages()
+	{
+		auto const messages = make_messages(1024*1024);
+		printf("# %zu small messages\n", std::size(messages));
+		report_latency("parser, new for every message", messages, [](std::string_view data) {
+			jopp::container root;
+			jopp::parser parser{root};
+			check_result(parser.parse(data).ec);
+		});
+
+		jopp::container root;
+		jopp::parser parser{root};
+		report_latency("parser, reset for every message", messages, [&parser, &root](std::string_view data) {
+			parser.reset(root);
+			check_result(parser.parse(data).ec);
+		});
+	}
+
+	void bench_typed()
+	{
+		auto const messages = make_messages(1024*1024);
+		printf("# %zu small messages, decoded into a struct\n", std::size(messages));
+		report_latency("parser, then get_field_as", messages, [](std::string_view data) {
+			jopp::container root;
+			jopp::parser parser{root};
+			check_result(parser.parse(data).ec);
+
+			auto const& obj = root.get<jopp::object>();
+			auto const& data_obj = obj.get_field_as<jopp::object>("payload");
+			message msg{static_cast<size_t>(obj.get_field_as<jopp::number>("seq")),
+				std::string{obj.get_field_as<jopp::string>("topic")},
+				payload{data_obj.get_field_as<jopp::number>("value"), {}}};
+			for(auto const& item : data_obj.get_field_as<jopp::array>("tags"))
+			{ msg.data.tags.push_back(std::string{item.get<jopp::string>()}); }
+		});
+
+		report_latency("from_json", messages, [](std::string_view data) {
+			message msg;
+			check_result(jopp::from_json(data, msg).ec);
+		});
+	}
+
+	void bench_ndjson()
+	{
+		std::string data;
+		for(auto const& item : make_messages(256*1024))
+		{ data.append(item).append("\n"); }
+		printf("# NDJSON stream, %zu bytes\n", std::size(data));
+
+		report_throughput("stream_parser, 64 KiB blocks", data, [](std::string_view input) {
+			jopp::stream_parser parser;
+			size_t count = 0;
+			while(!input.empty())
+			{
+				auto const res = parser.parse(input.substr(0, 65536), [&count](jopp::container&&) { ++count; });
+				if(res.ec != jopp::parser_error_code::more_data_needed)
+				{ check_result(res.ec); }
+				input.remove_prefix(std::min(std::size(input), static_cast<size_t>(65536)));
+			}
+			if(count != 256*1024)
+			{ throw std::runtime_error{"Wrong number of documents"}; }
+		});
+
+		std::string broken_data;
+		size_t line_count = 0;
+		for(auto item : make_messages(256*1024))
+		{
+			if(line_count % 1024 == 0)
+			{ item[item.find(':')] = ','; }
+			broken_data.append(item).append("\n");
+			++line_count;
+		}
+
+		report_throughput("stream_parser, one broken line in 1024", broken_data, [line_count](std::string_view input) {
+			jopp::stream_parser parser;
+			size_t count = 0;
+			while(!input.empty())
+			{
+				auto const block = input.substr(0, 65536);
+				auto res = parser.parse(block, [&count](jopp::container&&) { ++count; });
+				while(res.ec != jopp::parser_error_code::more_data_needed)
+				{
+					parser.skip_line();
+					res = parser.parse(std::string_view{res.ptr, std::end(block)}, [&count](jopp::container&&) { ++count; });
+				}
+				input.remove_prefix(std::size(block));
+			}
+			if(count != line_count - line_count/1024)
+			{ throw std::runtime_error{"Wrong number of documents"}; }
+		});
+	}
+
+	void bench_ndjson_parallel()
+	{
+		constexpr size_t corpus_size = size_t{2} << 30;
+		auto const messages = make_messages(64*1024);
+		std::string data;
+		data.reserve(corpus_size + 1024);
+		size_t count = 0;
+		while(std::size(data) < corpus_size)
+		{
+			data.append(messages[count % std::size(messages)]).append("\n");
+			++count;
+		}
+		printf("# NDJSON corpus, %zu bytes, %zu documents, %u hardware threads\n",
+			std::size(data),
+			count,
+			std::thread::hardware_concurrency());
+
+		// Rows with more threads than the machine has only measure the overhead of oversubscription
+		for(size_t threads = 1; threads <= 16; threads *= 2)
+		{
+			jopp::ndjson_options options;
+			options.thread_count = threads;
+			size_t received = 0;
+			auto const t0 = std::chrono::steady_clock::now();
+			auto const res = jopp::parse_ndjson(data, [&received](jopp::ndjson_document&&) { ++received; }, options);
+			auto const t1 = std::chrono::steady_clock::now();
+			check_result(res.ec);
+			if(received != count)
+			{ throw std::runtime_error{"Wrong number of documents"}; }
+
+			auto const seconds = std::chrono::duration<double>(t1 - t0).count();
+			printf("parse_ndjson, %3zu threads %19.1f MB/s\n", threads, static_cast<double>(std::size(data))/(seconds*1.0e6));
+		}
+	}
+
+	struct benchmark
+	{
+		std::string_view name;
+		void (*run)();
+	};
+
+	constexpr benchmark benchmarks[]{
+		{"parse", bench_parse},
+		{"filtered", bench_filtered},
+		{"serialize", bench_serialize},
+		{"escape", bench_escape},
+		{"numbers", bench_numbers},
+		{"messages", bench_messages},
+		{"typed", bench_typed},
+		{"ndjson", bench_ndjson},
+		{"ndjson_parallel", bench_ndjson_parallel},
+		{"memory", bench_memory}
+	};
+}
+
+int main(int argc, char** argv)
+{
+	for(auto const& item : benchmarks)
+	{
+		if(argc < 2 || std::find(argv + 1, argv + argc, item.name) != argv + argc)
+		{
+			printf("## %s\n", std::data(item.name));
+			item.run();
+		}
+	}
+}
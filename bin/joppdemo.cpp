@@ -2,13 +2,25 @@
 
 #include "lib/parser.hpp"
 #include "lib/serializer.hpp"
+#include "lib/mapped_file.hpp"
 #include <unistd.h>
 #include <errno.h>
 
-int main()
+int main(int argc, char** argv)
 {
 	jopp::container root;
 
+	if(argc > 1)
+	{
+		// Read data from a file, by mapping it into memory
+		auto const res = jopp::parse_file(argv[1], root);
+		if(res.ec != jopp::parser_error_code::completed)
+		{
+			fprintf(stderr, "%s:%zu:%zu: error: %s\n", argv[1], res.line, res.col, to_string(res.ec));
+			return -1;
+		}
+	}
+	else
 	{
 		// Read data from stdin
 		jopp::parser parser{root};
@@ -0,0 +1,330 @@
+#ifndef JOPP_ASYNC_HPP
+#define JOPP_ASYNC_HPP
+
+#include "./parser.hpp"
+#include "./serializer.hpp"
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <system_error>
+#include <array>
+#include <utility>
+#include <span>
+
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <errno.h>
+
+namespace jopp::inline JOPP_OBJECT_STORAGE_NAMESPACE
+{
+	// A lazily started coroutine that produces a value of type T. Another coroutine can wait for
+	// it with co_await. A top-level task is started with start, and driven by an event_loop.
+	template<class T>
+	class task
+	{
+	public:
+		struct promise_type;
+
+		struct final_awaiter
+		{
+			bool await_ready() const noexcept
+			{ return false; }
+
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+			{
+				auto const continuation = handle.promise().continuation;
+				return continuation ? continuation : std::noop_coroutine();
+			}
+
+			void await_resume() const noexcept {}
+		};
+
+		struct promise_type
+		{
+			task get_return_object()
+			{ return task{std::coroutine_handle<promise_type>::from_promise(*this)}; }
+
+			std::suspend_always initial_suspend() const noexcept
+			{ return std::suspend_always{}; }
+
+			final_awaiter final_suspend() const noexcept
+			{ return final_awaiter{}; }
+
+			void return_value(T val)
+			{ result = std::move(val); }
+
+			void unhandled_exception()
+			{ exception = std::current_exception(); }
+
+			std::optional<T> result;
+			std::exception_ptr exception;
+			std::coroutine_handle<> continuation;
+		};
+
+		task(task&& other) noexcept:m_handle{std::exchange(other.m_handle, nullptr)}
+		{}
+
+		task& operator=(task&& other) noexcept
+		{
+			std::swap(m_handle, other.m_handle);
+			return *this;
+		}
+
+		~task()
+		{
+			if(m_handle)
+			{ m_handle.destroy(); }
+		}
+
+		// Runs the task until it has to wait for the first time
+		void start()
+		{ m_handle.resume(); }
+
+		bool done() const
+		{ return m_handle.done(); }
+
+		// Rethrows any exception thrown by the coroutine. Only call this when the task is done.
+		T& result()
+		{
+			auto& promise = m_handle.promise();
+			if(promise.exception)
+			{ std::rethrow_exception(promise.exception); }
+			return *promise.result;
+		}
+
+		bool await_ready() const noexcept
+		{ return false; }
+
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept
+		{
+			m_handle.promise().continuation = caller;
+			return m_handle;
+		}
+
+		T await_resume()
+		{ return std::move(result()); }
+
+	private:
+		explicit task(std::coroutine_handle<promise_type> handle):m_handle{handle}
+		{}
+
+		std::coroutine_handle<promise_type> m_handle;
+	};
+
+	// Resumes coroutines that wait for a file descriptor to become readable or writable. Only one
+	// coroutine at a time may wait for a given file descriptor.
+	class event_loop
+	{
+	public:
+		struct io_awaiter
+		{
+			bool await_ready() const noexcept
+			{ return false; }
+
+			void await_suspend(std::coroutine_handle<> handle)
+			{ loop.watch(fd, events, handle); }
+
+			void await_resume() const noexcept {}
+
+			event_loop& loop;
+			int fd;
+			uint32_t events;
+		};
+
+		event_loop():m_fd{::epoll_create1(EPOLL_CLOEXEC)}, m_waiting{0}
+		{
+			if(m_fd == -1)
+			{ throw std::system_error{errno, std::generic_category(), "Failed to create event loop"}; }
+		}
+
+		event_loop(event_loop const&) = delete;
+		event_loop& operator=(event_loop const&) = delete;
+
+		~event_loop()
+		{ ::close(m_fd); }
+
+		io_awaiter readable(int fd)
+		{ return io_awaiter{*this, fd, EPOLLIN}; }
+
+		io_awaiter writable(int fd)
+		{ return io_awaiter{*this, fd, EPOLLOUT}; }
+
+		// Resumes waiting coroutines as their file descriptors become ready, until no coroutine
+		// is waiting anymore
+		void run()
+		{
+			std::array<epoll_event, 64> events{};
+			while(m_waiting != 0)
+			{
+				auto const n = ::epoll_wait(m_fd, std::data(events), static_cast<int>(std::size(events)), -1);
+				if(n == -1)
+				{
+					if(errno == EINTR)
+					{ continue; }
+					throw std::system_error{errno, std::generic_category(), "Failed to wait for events"};
+				}
+
+				for(int k = 0; k != n; ++k)
+				{
+					--m_waiting;
+					std::coroutine_handle<>::from_address(events[static_cast<size_t>(k)].data.ptr).resume();
+				}
+			}
+		}
+
+		size_t waiting() const
+		{ return m_waiting; }
+
+	private:
+		void watch(int fd, uint32_t events, std::coroutine_handle<> handle)
+		{
+			// One-shot, so that the coroutine is resumed only once per wait
+			epoll_event event{};
+			event.events = events | EPOLLONESHOT;
+			event.data.ptr = handle.address();
+			if(::epoll_ctl(m_fd, EPOLL_CTL_MOD, fd, &event) == -1)
+			{
+				if(errno != ENOENT || ::epoll_ctl(m_fd, EPOLL_CTL_ADD, fd, &event) == -1)
+				{ throw std::system_error{errno, std::generic_category(), "Failed to watch file descriptor"}; }
+			}
+			++m_waiting;
+		}
+
+		int m_fd;
+		size_t m_waiting;
+	};
+
+	// Reads from a non-blocking file descriptor for async_parse. Data that has been read past the
+	// end of one document is kept, and is used first by the next call to async_parse. That way, a
+	// stream of documents, such as pipelined requests or NDJSON, can be read one document at a
+	// time. Use one reader per file descriptor.
+	class async_reader
+	{
+	public:
+		explicit async_reader(int fd):m_fd{fd}, m_buffer{}, m_begin{0}, m_end{0}, m_offset{0}
+		{}
+
+		int fd() const
+		{ return m_fd; }
+
+		// Data that has been read from fd, but not consumed by a parser
+		std::span<char const> pending() const
+		{ return std::span{std::data(m_buffer) + m_begin, m_end - m_begin}; }
+
+		void consume(size_t n)
+		{
+			m_begin += n;
+			m_offset += n;
+		}
+
+		// The number of bytes consumed from the start of the stream
+		size_t offset() const
+		{ return m_offset; }
+
+		// Replaces the buffer contents with new data. Only call this when nothing is pending. Like
+		// ::read, this returns 0 at the end of the stream, and -1 with errno set on failure.
+		ssize_t read()
+		{
+			auto const ret = ::read(m_fd, std::data(m_buffer), std::size(m_buffer));
+			m_begin = 0;
+			m_end = ret > 0 ? static_cast<size_t>(ret) : 0;
+			return ret;
+		}
+
+	private:
+		int m_fd;
+		std::array<char, 4096> m_buffer;
+		size_t m_begin;
+		size_t m_end;
+		size_t m_offset;
+	};
+
+	// Parses a document from the file descriptor of reader. Instead of spinning on EAGAIN, the
+	// coroutine waits in loop until the file descriptor becomes readable. Like with parse_file, ptr
+	// in the result is an offset from the start of the stream, while line and col are counted from
+	// the start of this document. loop, reader and root must outlive the task.
+	inline task<parse_result<size_t>> async_parse(event_loop& loop, async_reader& reader, container& root,
+		std::optional<size_t> max_levels = 1024,
+		std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+	{
+		parser parser{root, max_levels, resource};
+		parse_result<size_t> ret{reader.offset(), parser_error_code::more_data_needed, 1, 1};
+		while(true)
+		{
+			if(std::empty(reader.pending()))
+			{
+				auto const bytes_read = reader.read();
+				if(bytes_read == 0)
+				{ co_return ret; }
+
+				if(bytes_read == -1)
+				{
+					if(errno == EAGAIN || errno == EWOULDBLOCK)
+					{
+						co_await loop.readable(reader.fd());
+						continue;
+					}
+
+					if(errno == EINTR)
+					{ continue; }
+
+					throw std::system_error{errno, std::generic_category(), "Failed to read data"};
+				}
+			}
+
+			auto const input = reader.pending();
+			auto const res = parser.parse(input);
+			reader.consume(static_cast<size_t>(res.ptr - std::begin(input)));
+			ret = parse_result{reader.offset(), res.ec, res.line, res.col};
+			if(res.ec != parser_error_code::more_data_needed)
+			{ co_return ret; }
+		}
+	}
+
+	// Parses a single document from a non-blocking file descriptor. Data read past the end of the
+	// document is discarded, so use an async_reader to read more than one document from fd.
+	inline task<parse_result<size_t>> async_parse(event_loop& loop, int fd, container& root,
+		std::optional<size_t> max_levels = 1024,
+		std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+	{
+		async_reader reader{fd};
+		co_return co_await async_parse(loop, reader, root, max_levels, resource);
+	}
+
+	// Serializes root to a non-blocking file descriptor, waiting in loop whenever fd is not
+	// writable. loop and root must outlive the task.
+	inline task<serializer_error_code> async_serialize(event_loop& loop, int fd, container const& root)
+	{
+		serializer serializer{root};
+		std::array<char, 4096> buffer{};
+		while(true)
+		{
+			auto const res = serializer.serialize(buffer);
+			auto ptr = std::data(buffer);
+			while(ptr != res.ptr)
+			{
+				auto const bytes_written = ::write(fd, ptr, static_cast<size_t>(res.ptr - ptr));
+				if(bytes_written == -1)
+				{
+					if(errno == EAGAIN || errno == EWOULDBLOCK)
+					{
+						co_await loop.writable(fd);
+						continue;
+					}
+
+					if(errno == EINTR)
+					{ continue; }
+
+					throw std::system_error{errno, std::generic_category(), "Failed to write data"};
+				}
+				ptr += bytes_written;
+			}
+
+			if(res.ec != serializer_error_code::buffer_is_full)
+			{ co_return res.ec; }
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,204 @@
+//@	{"target":{"name":"async.test"}}
+
+#include "./async.hpp"
+
+#include <testfwk/testfwk.hpp>
+
+#include <sys/socket.h>
+#include <fcntl.h>
+
+#include <string>
+#include <vector>
+
+namespace
+{
+	struct socket_pair
+	{
+		socket_pair()
+		{
+			std::array<int, 2> fds{};
+			REQUIRE_EQ(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, std::data(fds)), 0);
+			reader = fds[0];
+			writer = fds[1];
+		}
+
+		socket_pair(socket_pair&& other) noexcept:
+			reader{std::exchange(other.reader, -1)},
+			writer{std::exchange(other.writer, -1)}
+		{}
+
+		~socket_pair()
+		{
+			if(reader != -1)
+			{ ::close(reader); }
+			if(writer != -1)
+			{ ::close(writer); }
+		}
+
+		int reader;
+		int writer;
+	};
+
+	jopp::container make_large_tree(size_t count)
+	{
+		jopp::array items;
+		for(size_t k = 0; k != count; ++k)
+		{
+			jopp::object obj;
+			obj.insert("seq", static_cast<jopp::number>(k));
+			obj.insert("name", jopp::string{"An item with a rather long name, to fill the socket buffer"});
+			items.push_back(std::move(obj));
+		}
+		return jopp::container{std::move(items)};
+	}
+
+	jopp::task<size_t> count_items(jopp::event_loop& loop, int fd, jopp::container& root)
+	{
+		auto const res = co_await jopp::async_parse(loop, fd, root);
+		if(res.ec != jopp::parser_error_code::completed)
+		{ co_return 0; }
+		co_return std::size(root.get<jopp::array>());
+	}
+}
+
+TESTCASE(jopp_async_parse_and_serialize)
+{
+	socket_pair sockets;
+	auto const src = make_large_tree(16384);
+	jopp::container dest;
+
+	jopp::event_loop loop;
+	auto writer = jopp::async_serialize(loop, sockets.writer, src);
+	auto reader = jopp::async_parse(loop, sockets.reader, dest);
+	writer.start();
+	reader.start();
+	EXPECT_EQ(writer.done(), false);
+	loop.run();
+
+	REQUIRE_EQ(writer.done(), true);
+	REQUIRE_EQ(reader.done(), true);
+	EXPECT_EQ(writer.result(), jopp::serializer_error_code::completed);
+	EXPECT_EQ(reader.result().ec, jopp::parser_error_code::completed);
+
+	auto const& items = dest.get<jopp::array>();
+	REQUIRE_EQ(std::size(items), 16384);
+	EXPECT_EQ(items[16383].get<jopp::object>().get_field_as<jopp::number>("seq"), 16383.0);
+}
+
+TESTCASE(jopp_async_many_sockets_one_thread)
+{
+	constexpr size_t count = 256;
+	auto const src = make_large_tree(64);
+	std::vector<socket_pair> sockets(count);
+	std::vector<jopp::container> dest(count);
+
+	jopp::event_loop loop;
+	std::vector<jopp::task<jopp::serializer_error_code>> writers;
+	std::vector<jopp::task<size_t>> readers;
+	for(size_t k = 0; k != count; ++k)
+	{
+		readers.push_back(count_items(loop, sockets[k].reader, dest[k]));
+		readers.back().start();
+	}
+	EXPECT_EQ(loop.waiting(), count);
+
+	for(size_t k = 0; k != count; ++k)
+	{
+		writers.push_back(jopp::async_serialize(loop, sockets[k].writer, src));
+		writers.back().start();
+	}
+	loop.run();
+
+	for(auto& item : readers)
+	{
+		REQUIRE_EQ(item.done(), true);
+		EXPECT_EQ(item.result(), 64);
+	}
+}
+
+TESTCASE(jopp_async_parse_eof_and_error)
+{
+	jopp::event_loop loop;
+	{
+		socket_pair sockets;
+		REQUIRE_EQ(::write(sockets.writer, "{\"a\": [1, 2", 11), 11);
+		::close(std::exchange(sockets.writer, -1));
+
+		jopp::container root;
+		auto reader = jopp::async_parse(loop, sockets.reader, root);
+		reader.start();
+		loop.run();
+		REQUIRE_EQ(reader.done(), true);
+		EXPECT_EQ(reader.result().ec, jopp::parser_error_code::more_data_needed);
+		EXPECT_EQ(reader.result().ptr, 11);
+	}
+
+	{
+		socket_pair sockets;
+		REQUIRE_EQ(::write(sockets.writer, "{\"a\": [1, x]}", 13), 13);
+
+		jopp::container root;
+		auto reader = jopp::async_parse(loop, sockets.reader, root);
+		reader.start();
+		loop.run();
+		REQUIRE_EQ(reader.done(), true);
+		EXPECT_EQ(reader.result().ec, jopp::parser_error_code::invalid_value);
+		EXPECT_EQ(reader.result().col, 12);
+	}
+
+	{
+		jopp::container root;
+		auto reader = jopp::async_parse(loop, -1, root);
+		reader.start();
+		REQUIRE_EQ(reader.done(), true);
+		try
+		{
+			(void)reader.result();
+			EXPECT_EQ(true, false);
+		}
+		catch(std::system_error const& err)
+		{ EXPECT_EQ(err.code().value(), EBADF); }
+	}
+}
+
+TESTCASE(jopp_async_parse_keeps_data_after_document)
+{
+	socket_pair sockets;
+	std::string_view const input{"{\"a\": 1}\n[2, 3]\n"};
+	REQUIRE_EQ(::write(sockets.writer, std::data(input), std::size(input)), static_cast<ssize_t>(std::size(input)));
+	::close(std::exchange(sockets.writer, -1));
+
+	jopp::event_loop loop;
+	jopp::async_reader reader{sockets.reader};
+	{
+		jopp::container root;
+		auto task = jopp::async_parse(loop, reader, root);
+		task.start();
+		loop.run();
+		REQUIRE_EQ(task.done(), true);
+		EXPECT_EQ(task.result().ec, jopp::parser_error_code::completed);
+		EXPECT_EQ(task.result().ptr, 8);
+		EXPECT_EQ(root.get<jopp::object>().get_field_as<jopp::number>("a"), 1.0);
+	}
+
+	{
+		jopp::container root;
+		auto task = jopp::async_parse(loop, reader, root);
+		task.start();
+		loop.run();
+		REQUIRE_EQ(task.done(), true);
+		EXPECT_EQ(task.result().ec, jopp::parser_error_code::completed);
+		EXPECT_EQ(task.result().ptr, 15);
+		REQUIRE_EQ(std::size(root.get<jopp::array>()), 2);
+		EXPECT_EQ(root.get<jopp::array>()[1].get<jopp::number>(), 3.0);
+	}
+
+	{
+		jopp::container root;
+		auto task = jopp::async_parse(loop, reader, root);
+		task.start();
+		loop.run();
+		REQUIRE_EQ(task.done(), true);
+		EXPECT_EQ(task.result().ec, jopp::parser_error_code::more_data_needed);
+	}
+}
@@ -0,0 +1,115 @@
+#ifndef JOPP_CONST_KEY_ITERATOR_HPP
+#define JOPP_CONST_KEY_ITERATOR_HPP
+
+#include <iterator>
+#include <compare>
+#include <type_traits>
+#include <utility>
+
+namespace jopp
+{
+	// Iterates over a vector of std::pair<Key, T>, but only gives access to the keys through const
+	// references, so that a key cannot be changed behind the back of the map that owns it.
+	// Dereferencing gives a std::pair<Key const&, T&> by value, like std::flat_map does.
+	template<class Iterator>
+	class const_key_iterator
+	{
+		using item_type = std::remove_reference_t<std::iter_reference_t<Iterator>>;
+		using key_type = typename std::remove_const_t<item_type>::first_type;
+		using mapped_type = typename std::remove_const_t<item_type>::second_type;
+		using mapped_reference = std::conditional_t<std::is_const_v<item_type>,
+			mapped_type const&,
+			mapped_type&>;
+
+	public:
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = std::pair<key_type const, mapped_type>;
+		using difference_type = std::iter_difference_t<Iterator>;
+		using reference = std::pair<key_type const&, mapped_reference>;
+
+		struct pointer
+		{
+			reference item;
+
+			reference const* operator->() const
+			{ return &item; }
+		};
+
+		const_key_iterator() = default;
+
+		explicit const_key_iterator(Iterator base):m_base{base}
+		{}
+
+		template<class Other>
+		requires(std::is_convertible_v<Other, Iterator> && !std::is_same_v<Other, Iterator>)
+		const_key_iterator(const_key_iterator<Other> other):m_base{other.base()}
+		{}
+
+		Iterator base() const
+		{ return m_base; }
+
+		reference operator*() const
+		{ return reference{m_base->first, m_base->second}; }
+
+		pointer operator->() const
+		{ return pointer{**this}; }
+
+		reference operator[](difference_type n) const
+		{ return *(*this + n); }
+
+		const_key_iterator& operator++()
+		{
+			++m_base;
+			return *this;
+		}
+
+		const_key_iterator operator++(int)
+		{ return const_key_iterator{m_base++}; }
+
+		const_key_iterator& operator--()
+		{
+			--m_base;
+			return *this;
+		}
+
+		const_key_iterator operator--(int)
+		{ return const_key_iterator{m_base--}; }
+
+		const_key_iterator& operator+=(difference_type n)
+		{
+			m_base += n;
+			return *this;
+		}
+
+		const_key_iterator& operator-=(difference_type n)
+		{
+			m_base -= n;
+			return *this;
+		}
+
+		friend const_key_iterator operator+(const_key_iterator i, difference_type n)
+		{ return i += n; }
+
+		friend const_key_iterator operator+(difference_type n, const_key_iterator i)
+		{ return i += n; }
+
+		friend const_key_iterator operator-(const_key_iterator i, difference_type n)
+		{ return i -= n; }
+
+		friend difference_type operator-(const_key_iterator const& a, const_key_iterator const& b)
+		{ return a.m_base - b.m_base; }
+
+		template<class Other>
+		friend bool operator==(const_key_iterator const& a, const_key_iterator<Other> const& b)
+		{ return a.m_base == b.base(); }
+
+		template<class Other>
+		friend auto operator<=>(const_key_iterator const& a, const_key_iterator<Other> const& b)
+		{ return a.m_base <=> b.base(); }
+
+	private:
+		Iterator m_base;
+	};
+}
+
+#endif
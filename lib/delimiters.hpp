@@ -1,9 +1,16 @@
 #ifndef JOPP_DELIMITERS_HPP
 #define JOPP_DELIMITERS_HPP
 
+#include "./simd.hpp"
+
 #include <optional>
 #include <string>
 #include <string_view>
+#include <bit>
+#include <span>
+#include <algorithm>
+#include <cstring>
+#include <array>
 
 namespace jopp
 {
@@ -24,6 +31,38 @@ namespace jopp
 	inline constexpr auto char_should_be_escaped(char ch)
 	{ return (ch >= '\0' && ch <= '\x1f') || ch == '"' || ch == '\\'; }
 
+	inline char const* find_char_to_escape(char const* begin, char const* end)
+	{
+		while(end - begin >= static_cast<ptrdiff_t>(simd::char_block::size))
+		{
+			simd::char_block const block{begin};
+			auto const mask = block.eq('"') | block.eq('\\') | block.less_equal('\x1f');
+			if(mask != 0)
+			{ return begin + std::countr_zero(mask); }
+			begin += simd::char_block::size;
+		}
+
+		while(begin != end && !char_should_be_escaped(*begin))
+		{ ++begin; }
+
+		return begin;
+	}
+
+	inline constexpr auto is_literal_terminator(char ch)
+	{
+		return ch == delimiters::value_separator
+			|| ch == delimiters::end_array
+			|| ch == delimiters::end_object
+			|| is_whitespace(ch);
+	}
+
+	inline char const* find_literal_end(char const* begin, char const* end)
+	{
+		while(begin != end && !is_literal_terminator(*begin))
+		{ ++begin; }
+		return begin;
+	}
+
 	inline constexpr auto begin_esc_seq = '\\';
 
 	namespace esc_chars
@@ -68,38 +107,121 @@ namespace jopp
 		}
 	}
 
-	inline std::optional<std::string> escape(std::string_view val)
+	enum class escape_status
+	{
+		completed,
+		buffer_is_full,
+		illegal_char
+	};
+
+	struct escape_result
+	{
+		char const* in;
+		char* out;
+		escape_status status;
+	};
+
+	// Writes val, with escape sequences, into output. An escape sequence is never split, so
+	// buffer_is_full may leave one byte of output unused.
+	inline escape_result escape(std::string_view val, std::span<char> output)
 	{
-		std::string ret;
-		ret.reserve(std::size(val));
-		for(size_t k = 0; k != std::size(val); ++k)
+		auto in = std::data(val);
+		auto const in_end = in + std::size(val);
+		auto out = std::data(output);
+		auto const out_end = out + std::size(output);
+		while(true)
 		{
-			if(char_should_be_escaped(val[k]))
+			// Copy whole blocks, and then step back to the first char that needs an escape sequence
+			while(in_end - in >= static_cast<ptrdiff_t>(simd::char_block::size)
+				&& out_end - out >= static_cast<ptrdiff_t>(simd::char_block::size))
 			{
-				auto const esc_char = get_escape_char(val[k]);
-				if(!esc_char.has_value())
-				{ return std::nullopt; }
-
-				ret.push_back(begin_esc_seq);
-				ret.push_back(*esc_char);
+				simd::char_block const block{in};
+				auto const mask = block.eq('"') | block.eq('\\') | block.less_equal('\x1f');
+				memcpy(out, in, simd::char_block::size);
+				auto const n = mask == 0 ? simd::char_block::size : static_cast<size_t>(std::countr_zero(mask));
+				in += n;
+				out += n;
+				if(mask != 0)
+				{ break; }
 			}
-			else
-			{ ret.push_back(val[k]); }
+
+			auto const run_end = find_char_to_escape(in, in + std::min(in_end - in, out_end - out));
+			out = std::copy(in, run_end, out);
+			in = run_end;
+			if(in == in_end)
+			{ return escape_result{in, out, escape_status::completed}; }
+
+			if(!char_should_be_escaped(*in))
+			{ return escape_result{in, out, escape_status::buffer_is_full}; }
+
+			auto const esc_char = get_escape_char(*in);
+			if(!esc_char.has_value())
+			{ return escape_result{in, out, escape_status::illegal_char}; }
+
+			if(out_end - out < 2)
+			{ return escape_result{in, out, escape_status::buffer_is_full}; }
+
+			out[0] = begin_esc_seq;
+			out[1] = *esc_char;
+			out += 2;
+			++in;
 		}
+	}
+
+	// A string is never more than twice as long when escaped
+	inline constexpr size_t max_escaped_size(size_t size)
+	{ return 2*size; }
 
+	// The length of val with escape sequences, or nullopt if val contains a char that cannot be escaped
+	inline std::optional<size_t> escaped_size(std::string_view val)
+	{
+		auto ptr = std::data(val);
+		auto const end = ptr + std::size(val);
+		auto ret = std::size(val);
+		while(true)
+		{
+			ptr = find_char_to_escape(ptr, end);
+			if(ptr == end)
+			{ return ret; }
+
+			if(!get_escape_char(*ptr).has_value())
+			{ return std::nullopt; }
+
+			++ret;
+			++ptr;
+		}
+	}
+
+	inline std::optional<std::string> escape(std::string_view val)
+	{
+		// Short strings are escaped on the stack, so that the result is allocated with its final size
+		if(std::size(val) <= simd::char_block::size)
+		{
+			std::array<char, max_escaped_size(simd::char_block::size)> buffer;
+			auto const res = escape(val, buffer);
+			if(res.status != escape_status::completed)
+			{ return std::nullopt; }
+			return std::string{std::data(buffer), res.out};
+		}
+
+		std::string ret(max_escaped_size(std::size(val)), '\0');
+		auto const res = escape(val, ret);
+		if(res.status != escape_status::completed)
+		{ return std::nullopt; }
+
+		ret.resize(static_cast<size_t>(res.out - std::data(ret)));
 		return ret;
 	}
 
 	inline std::optional<std::string> wrap_string(std::string_view val)
 	{
-		auto escaped_string = escape(val);
-		if(!escaped_string.has_value())
+		std::string ret(max_escaped_size(std::size(val)) + 2, delimiters::string_begin_end);
+		auto const res = escape(val, std::span{std::data(ret) + 1, std::size(ret) - 2});
+		if(res.status != escape_status::completed)
 		{ return std::nullopt; }
 
-		std::string ret{delimiters::string_begin_end};
-		ret.append(*escaped_string);
-		ret += delimiters::string_begin_end;
-
+		*res.out = delimiters::string_begin_end;
+		ret.resize(static_cast<size_t>(res.out + 1 - std::data(ret)));
 		return ret;
 	}
 }
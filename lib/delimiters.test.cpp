@@ -4,6 +4,9 @@
 
 #include "testfwk/testfwk.hpp"
 
+#include <array>
+#include <vector>
+
 TESTCASE(jopp_is_whitespace)
 {
 	for(int k = 0; k != 255; ++k)
@@ -26,6 +29,23 @@ TESTCASE(jopp_char_should_be_escaped)
 	}
 }
 
+TESTCASE(jopp_find_char_to_escape)
+{
+	for(int k = 0; k != 255; ++k)
+	{
+		for(size_t pos : {0, 5, 63, 64, 65, 130, 199})
+		{
+			std::string str(200, 'a');
+			str[pos] = static_cast<char>(k);
+			auto const res = jopp::find_char_to_escape(std::data(str), std::data(str) + std::size(str));
+			if(jopp::char_should_be_escaped(static_cast<char>(k)))
+			{ EXPECT_EQ(res, std::data(str) + pos); }
+			else
+			{ EXPECT_EQ(res, std::data(str) + std::size(str)); }
+		}
+	}
+}
+
 TESTCASE(jopp_unescape)
 {
 	for(int k = 0; k != 255; ++k)
@@ -97,4 +117,61 @@ TESTCASE(jopp_escape_string_with_bad_char)
 		std::string_view{"This is a test string that contains bad chars \r"});
 
 	EXPECT_EQ(res.has_value(), false);
-}
\ No newline at end of file
+}
+
+TESTCASE(jopp_escaped_size)
+{
+	std::string input;
+	for(size_t k = 0; k != 200; ++k)
+	{ input += (k % 37 == 0) ? '"' : (k % 53 == 0 ? '\n' : static_cast<char>('a' + k % 26)); }
+	EXPECT_EQ(jopp::escaped_size(input).value(), std::size(jopp::escape(input).value()));
+	EXPECT_EQ(jopp::escaped_size("").value(), 0);
+	EXPECT_EQ(jopp::escaped_size(input + "\r").has_value(), false);
+}
+
+TESTCASE(jopp_escape_into_buffer)
+{
+	std::string input;
+	for(size_t k = 0; k != 200; ++k)
+	{ input += (k % 37 == 0) ? '"' : (k % 53 == 0 ? '\n' : static_cast<char>('a' + k % 26)); }
+	auto const expected = *jopp::escape(input);
+	EXPECT_EQ(std::size(expected), std::size(input) + 9);
+
+	// Fill in a buffer of each size, and continue where the previous call stopped
+	for(size_t buffer_size = 2; buffer_size != 80; ++buffer_size)
+	{
+		std::string output;
+		std::string_view remaining{input};
+		while(true)
+		{
+			std::vector<char> buffer(buffer_size);
+			auto const res = jopp::escape(remaining, buffer);
+			output.append(std::data(buffer), res.out);
+			remaining.remove_prefix(static_cast<size_t>(res.in - std::data(remaining)));
+			if(res.status == jopp::escape_status::completed)
+			{ break; }
+			REQUIRE_EQ(res.status, jopp::escape_status::buffer_is_full);
+			REQUIRE_EQ(res.out >= std::data(buffer) + buffer_size - 1, true);
+		}
+		EXPECT_EQ(output, expected);
+	}
+
+	{
+		std::array<char, 1> buffer{};
+		auto const res = jopp::escape(std::string_view{"\""}, buffer);
+		EXPECT_EQ(res.status, jopp::escape_status::buffer_is_full);
+		EXPECT_EQ(res.out, std::data(buffer));
+	}
+
+	{
+		std::string const bad = std::string(100, 'x') + "\r";
+		std::array<char, 256> buffer{};
+		auto const res = jopp::escape(bad, buffer);
+		EXPECT_EQ(res.status, jopp::escape_status::illegal_char);
+		EXPECT_EQ(res.in, std::data(bad) + 100);
+	}
+
+	EXPECT_EQ(jopp::wrap_string("a\tb").value(), "\"a\\tb\"");
+	EXPECT_EQ(jopp::wrap_string("").value(), "\"\"");
+	EXPECT_EQ(jopp::escape(std::string_view{""}).value(), "");
+}
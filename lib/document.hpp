@@ -0,0 +1,54 @@
+#ifndef JOPP_DOCUMENT_HPP
+#define JOPP_DOCUMENT_HPP
+
+#include "./fast_parser.hpp"
+
+#include <memory>
+#include <string>
+
+namespace jopp::inline JOPP_OBJECT_STORAGE_NAMESPACE
+{
+	// Owns the input together with the tree, so that string values can refer to the input
+	// instead of being copied
+	class document
+	{
+	public:
+		explicit document(std::string&& input,
+			std::pmr::memory_resource* resource = std::pmr::get_default_resource()):
+			document{std::make_shared<std::string const>(std::move(input)), resource}
+		{}
+
+		// Keeps owner alive for as long as the document, so that input, which is owned by it,
+		// stays valid
+		explicit document(std::shared_ptr<void const> owner, std::string_view input,
+			std::pmr::memory_resource* resource = std::pmr::get_default_resource()):
+			m_owner{std::move(owner)},
+			m_input{input},
+			m_resource{resource}
+		{}
+
+		parse_result<char const*> parse(std::optional<size_t> max_levels = 1024)
+		{
+			fast_parser parser{m_root, max_levels, m_resource, string_storage::reference_input};
+			return parser.parse(m_input);
+		}
+
+		container const& root() const
+		{ return m_root; }
+
+		std::string_view input() const
+		{ return m_input; }
+
+	private:
+		explicit document(std::shared_ptr<std::string const> input, std::pmr::memory_resource* resource):
+			document{input, std::string_view{*input}, resource}
+		{}
+
+		std::shared_ptr<void const> m_owner;
+		std::string_view m_input;
+		std::pmr::memory_resource* m_resource;
+		container m_root;
+	};
+}
+
+#endif
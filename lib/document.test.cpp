@@ -0,0 +1,115 @@
+//@	{"target":{"name":"document.test"}}
+
+#include "./document.hpp"
+#include "./serializer.hpp"
+
+#include <testfwk/testfwk.hpp>
+
+TESTCASE(jopp_string_ref_store_and_view)
+{
+	std::string_view str{"Hello, World"};
+	REQUIRE_EQ(jopp::string_ref::can_refer_to(str), true);
+	jopp::string_ref ref{str};
+	EXPECT_EQ(std::data(ref.view()), std::data(str));
+	EXPECT_EQ(ref.view(), str);
+	EXPECT_EQ(sizeof(ref), 8);
+	EXPECT_EQ(jopp::string_ref::can_refer_to(std::string(jopp::string_ref::max_size + 1, 'a')), false);
+}
+
+TESTCASE(jopp_value_string_ref)
+{
+	std::string_view str{"Hello, World"};
+	jopp::value a{jopp::string_ref{str}};
+	REQUIRE_NE(a.get_if<jopp::string_ref>(), nullptr);
+	EXPECT_EQ(a.get_if<jopp::string>(), nullptr);
+	EXPECT_EQ(to_string_view(a), str);
+	EXPECT_EQ(a, jopp::value{"Hello, World"});
+	EXPECT_EQ(to_string_view(jopp::value{1.0}).has_value(), false);
+}
+
+TESTCASE(jopp_document_parse)
+{
+	jopp::document doc{std::string{R"({"no escapes": "A string without escapes", "escapes": "Tab\there"})"}};
+	auto const res = doc.parse();
+	REQUIRE_EQ(res.ec, jopp::parser_error_code::completed);
+
+	auto const& root = doc.root().get<jopp::object>();
+	auto const& ref = root.get_field_as<jopp::string_ref>("no escapes");
+	EXPECT_EQ(ref.view(), "A string without escapes");
+	EXPECT_EQ(std::data(ref.view()) >= std::data(doc.input()), true);
+	EXPECT_EQ(std::data(ref.view()) < std::data(doc.input()) + std::size(doc.input()), true);
+
+	EXPECT_EQ(root.get_field_as<jopp::string>("escapes"), "Tab\there");
+
+	auto moved = std::move(doc);
+	EXPECT_EQ(moved.root().get<jopp::object>().get_field_as<jopp::string_ref>("no escapes").view(),
+		"A string without escapes");
+
+	std::array<char, 1024> buffer{};
+	jopp::serializer serializer{moved.root()};
+	auto const ser_res = serializer.serialize(buffer);
+	EXPECT_EQ(ser_res.ec, jopp::serializer_error_code::completed);
+	EXPECT_EQ((std::string_view{std::data(buffer), ser_res.ptr}),
+		std::string_view{R"({"escapes":"Tab\there","no escapes":"A string without escapes"}
+)"});
+}
+
+TESTCASE(jopp_document_read_strings_as_string_view)
+{
+	jopp::document doc{std::string{R"({"no escapes": "Plain", "escapes": "Tab\there", "number": 1})"}};
+	REQUIRE_EQ(doc.parse().ec, jopp::parser_error_code::completed);
+
+	auto const& root = doc.root().get<jopp::object>();
+	EXPECT_EQ(root.get_field_as<std::string_view>("no escapes"), "Plain");
+	EXPECT_EQ(root.get_field_as<std::string_view>("escapes"), "Tab\there");
+	EXPECT_EQ(root.try_get_field_as<std::string_view>("no escapes").value(), "Plain");
+	EXPECT_EQ(root.try_get_field_as<std::string_view>("escapes").value(), "Tab\there");
+	EXPECT_EQ(root.try_get_field_as<std::string_view>("number").has_value(), false);
+	EXPECT_EQ(root.try_get_field_as<std::string_view>("missing").has_value(), false);
+
+	jopp::string const& owned = root.get_field_as<jopp::string>("escapes");
+	EXPECT_EQ(owned, "Tab\there");
+	EXPECT_EQ(root.try_get_field_as<jopp::string>("escapes"), &owned);
+	EXPECT_EQ(root.try_get_field_as<jopp::string>("no escapes"), nullptr);
+
+	auto const& value = root.find("no escapes")->second;
+	EXPECT_EQ(value.get<std::string_view>(), "Plain");
+	try
+	{
+		(void)value.get<jopp::string>();
+		EXPECT_EQ(true, false);
+	}
+	catch(jopp::field_type_mismatch_error const& err)
+	{ EXPECT_EQ(std::string_view{err.what()}.find("std::string_view") != std::string_view::npos, true); }
+
+	try
+	{
+		(void)root.get_field_as<jopp::string>("no escapes");
+		EXPECT_EQ(true, false);
+	}
+	catch(jopp::field_type_mismatch_error const& err)
+	{ EXPECT_EQ(std::string_view{err.what()}.find("std::string_view") != std::string_view::npos, true); }
+
+	try
+	{
+		(void)root.get_field_as<std::string_view>("number");
+		EXPECT_EQ(true, false);
+	}
+	catch(jopp::field_type_mismatch_error const& err)
+	{ EXPECT_EQ(std::string_view{err.what()}, "Field `number` should be a string"); }
+}
+
+TESTCASE(jopp_fast_parser_reference_input)
+{
+	std::string_view data{R"(["a", "b\"c", "d"])"};
+	jopp::container val;
+	jopp::fast_parser parser{val, 1024, std::pmr::get_default_resource(),
+		jopp::string_storage::reference_input};
+	REQUIRE_EQ(parser.parse(data).ec, jopp::parser_error_code::completed);
+
+	auto const& array = val.get<jopp::array>();
+	REQUIRE_EQ(std::size(array), 3);
+	EXPECT_EQ(std::data(array[0].get<jopp::string_ref>().view()), std::data(data) + 2);
+	EXPECT_EQ(array[1].get<jopp::string>(), "b\"c");
+	EXPECT_EQ(array[2], jopp::value{"d"});
+}
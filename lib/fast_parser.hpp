@@ -0,0 +1,459 @@
+#ifndef JOPP_FAST_PARSER_HPP
+#define JOPP_FAST_PARSER_HPP
+
+#include "./parser.hpp"
+#include "./simd.hpp"
+
+#include <vector>
+#include <span>
+#include <algorithm>
+#include <bit>
+
+namespace jopp::inline JOPP_OBJECT_STORAGE_NAMESPACE
+{
+	struct structural_scanner_state
+	{
+		uint64_t prev_escaped{};
+		uint64_t prev_in_string{};
+		uint64_t prev_scalar{};
+	};
+
+	inline uint64_t find_escaped_chars(uint64_t backslash, uint64_t& prev_escaped)
+	{
+		constexpr uint64_t even_bits = 0x5555'5555'5555'5555;
+
+		backslash &= ~prev_escaped;
+		auto const follows_escape = (backslash << 1) | prev_escaped;
+		auto const odd_sequence_starts = backslash & ~even_bits & ~follows_escape;
+		uint64_t sequences_starting_on_even_bits{};
+		prev_escaped = __builtin_add_overflow(odd_sequence_starts, backslash,
+			&sequences_starting_on_even_bits) ? 1 : 0;
+		auto const invert_mask = sequences_starting_on_even_bits << 1;
+		return (even_bits ^ invert_mask) & follows_escape;
+	}
+
+	inline uint64_t find_structural_chars(simd::char_block const& block,
+		structural_scanner_state& state)
+	{
+		auto const escaped = find_escaped_chars(block.eq(begin_esc_seq), state.prev_escaped);
+		auto const quote = block.eq(delimiters::string_begin_end) & ~escaped;
+		auto const in_string = simd::prefix_xor(quote) ^ state.prev_in_string;
+		state.prev_in_string = static_cast<uint64_t>(static_cast<int64_t>(in_string) >> 63);
+
+		auto const whitespace = block.eq(' ') | block.eq('\t') | block.eq('\n') | block.eq('\r');
+		auto const op = block.eq(delimiters::begin_array) | block.eq(delimiters::begin_object)
+			| block.eq(delimiters::end_array) | block.eq(delimiters::end_object)
+			| block.eq(delimiters::name_separator) | block.eq(delimiters::value_separator);
+
+		auto const scalar = ~(op | whitespace | quote | in_string);
+		auto const literal_start = scalar & ~((scalar << 1) | state.prev_scalar);
+		state.prev_scalar = scalar >> 63;
+
+		return (op & ~in_string) | (quote & in_string) | literal_start;
+	}
+
+	class structural_cursor
+	{
+	public:
+		static constexpr auto npos = static_cast<size_t>(-1);
+
+		explicit structural_cursor(std::span<uint64_t const> masks):
+			m_masks{masks},
+			m_block{0},
+			m_bits{std::empty(masks) ? 0 : masks[0]}
+		{}
+
+		size_t next()
+		{
+			while(m_bits == 0)
+			{
+				++m_block;
+				if(m_block >= std::size(m_masks))
+				{ return npos; }
+				m_bits = m_masks[m_block];
+			}
+
+			auto const ret = m_block*simd::char_block::size + static_cast<size_t>(std::countr_zero(m_bits));
+			m_bits &= m_bits - 1;
+			return ret;
+		}
+
+		void skip_to(size_t pos)
+		{
+			auto const block = pos/simd::char_block::size;
+			if(block < m_block)
+			{ return; }
+
+			if(block > m_block)
+			{
+				m_block = block;
+				m_bits = block < std::size(m_masks) ? m_masks[block] : 0;
+			}
+			m_bits &= ~((uint64_t{1} << (pos % simd::char_block::size)) - 1);
+		}
+
+	private:
+		std::span<uint64_t const> m_masks;
+		size_t m_block;
+		uint64_t m_bits;
+	};
+
+	class structural_index
+	{
+	public:
+		void build(std::span<char const> input)
+		{
+			m_masks.clear();
+			m_masks.reserve((std::size(input) + simd::char_block::size - 1)/simd::char_block::size);
+
+			structural_scanner_state state{};
+			auto ptr = std::data(input);
+			auto const end = ptr + std::size(input);
+			while(end - ptr >= static_cast<ptrdiff_t>(simd::char_block::size))
+			{
+				m_masks.push_back(find_structural_chars(simd::char_block{ptr}, state));
+				ptr += simd::char_block::size;
+			}
+
+			if(ptr != end)
+			{
+				std::array<char, simd::char_block::size> tail;
+				tail.fill(' ');
+				std::copy(ptr, end, std::begin(tail));
+				m_masks.push_back(find_structural_chars(simd::char_block{std::data(tail)}, state));
+			}
+		}
+
+		auto get_cursor() const
+		{ return structural_cursor{m_masks}; }
+
+	private:
+		std::vector<uint64_t> m_masks;
+	};
+
+	struct decode_result
+	{
+		char const* ptr;
+		parser_error_code ec;
+	};
+
+	// Appends the string starting at ptr, just after the opening quote, to output. On success, ptr
+	// in the result is just after the closing quote.
+	inline decode_result decode_string(char const* ptr, char const* end, string& output);
+
+	enum class string_storage
+	{
+		copy,
+		reference_input
+	};
+
+	class fast_parser
+	{
+	public:
+		explicit fast_parser(container& root,
+			std::optional<size_t> max_levels = 1024,
+			std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+			string_storage storage = string_storage::copy):
+			m_max_levels{max_levels},
+			m_root{root},
+			m_resource{resource},
+			m_builder{root, resource},
+			m_string_storage{storage}
+		{}
+
+		parse_result<char const*> parse(std::span<char const> input)
+		{ return parse(input, false); }
+
+		parse_result<char const*> parse(std::string_view input)
+		{ return parse(std::span{std::data(input), std::size(input)}); }
+
+		// Parses the elements of an array into root, as if input followed the opening bracket of
+		// the array. This completes at the closing bracket, or at a comma at the very end of
+		// input. Thus, a large array can be parsed in slices that split it at top-level commas.
+		parse_result<char const*> parse_elements(std::span<char const> input)
+		{ return parse(input, true); }
+
+		container const& root() const
+		{ return m_root; }
+
+		std::pmr::memory_resource* resource() const
+		{ return m_resource; }
+
+		// With string_storage::reference_input, string values without escape sequences refer to
+		// the input, which must then outlive the tree
+		string_storage get_string_storage() const
+		{ return m_string_storage; }
+
+	private:
+		parse_result<char const*> parse(std::span<char const> input, bool elements_only);
+
+		std::optional<size_t> m_max_levels;
+		structural_index m_index;
+		std::reference_wrapper<container> m_root;
+		std::pmr::memory_resource* m_resource;
+		dom_builder m_builder;
+		string_storage m_string_storage;
+	};
+}
+
+inline jopp::decode_result jopp::decode_string(char const* ptr, char const* end, string& output)
+{
+	while(true)
+	{
+		auto const run_end = find_char_to_escape(ptr, end);
+		output.append(ptr, run_end);
+		if(run_end == end)
+		{ return decode_result{end, parser_error_code::more_data_needed}; }
+
+		switch(*run_end)
+		{
+			case delimiters::string_begin_end:
+				return decode_result{run_end + 1, parser_error_code::completed};
+
+			case begin_esc_seq:
+			{
+				if(run_end + 1 == end)
+				{ return decode_result{end, parser_error_code::more_data_needed}; }
+
+				auto const val = unescape(run_end[1]);
+				if(!val.has_value())
+				{ return decode_result{run_end + 2, parser_error_code::unsupported_escape_sequence}; }
+				output += *val;
+				ptr = run_end + 2;
+				break;
+			}
+
+			default:
+				return decode_result{run_end + 1, parser_error_code::character_must_be_escaped};
+		}
+	}
+}
+
+inline jopp::parse_result<char const*> jopp::fast_parser::parse(std::span<char const> input, bool elements_only)
+{
+	auto const begin = std::data(input);
+	auto const end = begin + std::size(input);
+	auto const make_result = [begin](char const* ptr, parser_error_code ec) {
+		auto const pos = get_text_position(begin, ptr - 1);
+		return parse_result{ptr, ec, pos.line, pos.col};
+	};
+
+	auto& builder = m_builder;
+	builder.reset(m_root);
+	auto const after_value = [&builder]() {
+		return builder.in_array() ? parser_state::after_value_array : parser_state::after_value_object;
+	};
+
+	m_index.build(input);
+	auto cursor = m_index.get_cursor();
+	auto current_state = parser_state::value;
+	if(elements_only)
+	{ builder.on_begin_array(); }
+
+	while(true)
+	{
+		auto pos = cursor.next();
+		if(pos == structural_cursor::npos)
+		{
+			auto const text_pos = get_text_position(begin, end);
+			return parse_result{end, parser_error_code::more_data_needed, text_pos.line, text_pos.col};
+		}
+
+		auto reprocess = true;
+		while(reprocess)
+		{
+			reprocess = false;
+			auto const ch_in = begin[pos];
+			auto const ptr = begin + pos + 1;
+			switch(current_state)
+			{
+				case parser_state::value:
+					switch(ch_in)
+					{
+						case delimiters::begin_array:
+							if(m_max_levels.has_value() && builder.depth() == *m_max_levels)
+							{ return make_result(ptr, parser_error_code::nesting_level_too_deep); }
+							builder.on_begin_array();
+							break;
+
+						case delimiters::begin_object:
+							if(m_max_levels.has_value() && builder.depth() == *m_max_levels)
+							{ return make_result(ptr, parser_error_code::nesting_level_too_deep); }
+							builder.on_begin_object();
+							current_state = parser_state::before_key;
+							break;
+
+						case delimiters::end_array:
+							if(builder.depth() == 0)
+							{ return make_result(ptr, parser_error_code::no_top_level_node); }
+							if(!builder.in_array())
+							{ return make_result(ptr, parser_error_code::illegal_delimiter); }
+							current_state = parser_state::after_value_array;
+							reprocess = true;
+							break;
+
+						case delimiters::string_begin_end:
+						{
+							if(builder.depth() == 0)
+							{ return make_result(ptr, parser_error_code::no_top_level_node); }
+
+							auto const run_end = m_string_storage == string_storage::reference_input ?
+								find_char_to_escape(ptr, end) : ptr;
+							if(run_end != end && *run_end == delimiters::string_begin_end
+								&& m_string_storage == string_storage::reference_input
+								&& string_ref::can_refer_to(std::string_view{ptr, run_end}))
+							{
+								auto const res = builder.on_value(value{string_ref{std::string_view{ptr, run_end}}});
+								if(res != parser_error_code::more_data_needed)
+								{ return make_result(run_end + 1, res); }
+
+								current_state = after_value();
+								cursor.skip_to(static_cast<size_t>(run_end + 1 - begin));
+								break;
+							}
+
+							string str{m_resource};
+							auto const decode_res = decode_string(ptr, end, str);
+							if(decode_res.ec == parser_error_code::more_data_needed)
+							{
+								cursor.skip_to(std::size(input));
+								break;
+							}
+							if(decode_res.ec != parser_error_code::completed)
+							{ return make_result(decode_res.ptr, decode_res.ec); }
+
+							auto const res = builder.on_value(value{std::move(str)});
+							if(res != parser_error_code::more_data_needed)
+							{ return make_result(decode_res.ptr, res); }
+
+							current_state = after_value();
+							cursor.skip_to(static_cast<size_t>(decode_res.ptr - begin));
+							break;
+						}
+
+						default:
+						{
+							if(builder.depth() == 0)
+							{ return make_result(ptr, parser_error_code::no_top_level_node); }
+
+							auto const literal_end = find_literal_end(ptr, end);
+							if(literal_end == end)
+							{
+								cursor.skip_to(std::size(input));
+								break;
+							}
+
+							auto val = make_value(std::string_view{begin + pos, literal_end});
+							if(!val.has_value())
+							{ return make_result(literal_end + 1, parser_error_code::invalid_value); }
+
+							auto const res = builder.on_value(std::move(*val));
+							if(res != parser_error_code::more_data_needed)
+							{ return make_result(literal_end + 1, res); }
+
+							current_state = after_value();
+							pos = static_cast<size_t>(literal_end - begin);
+							cursor.skip_to(pos + 1);
+							reprocess = !is_whitespace(*literal_end);
+						}
+					}
+					break;
+
+				case parser_state::before_key:
+					switch(ch_in)
+					{
+						case delimiters::string_begin_end:
+						{
+							string key{m_resource};
+							auto const decode_res = decode_string(ptr, end, key);
+							if(decode_res.ec == parser_error_code::more_data_needed)
+							{
+								cursor.skip_to(std::size(input));
+								break;
+							}
+							if(decode_res.ec != parser_error_code::completed)
+							{ return make_result(decode_res.ptr, decode_res.ec); }
+
+							builder.on_key(std::move(key));
+							current_state = parser_state::before_value;
+							cursor.skip_to(static_cast<size_t>(decode_res.ptr - begin));
+							break;
+						}
+
+						case delimiters::end_object:
+							current_state = parser_state::after_value_object;
+							reprocess = true;
+							break;
+
+						default:
+							return make_result(ptr, parser_error_code::illegal_delimiter);
+					}
+					break;
+
+				case parser_state::before_value:
+					if(ch_in != delimiters::name_separator)
+					{ return make_result(ptr, parser_error_code::illegal_delimiter); }
+					current_state = parser_state::value;
+					break;
+
+				case parser_state::after_value_object:
+					switch(ch_in)
+					{
+						case delimiters::end_object:
+						{
+							if(auto const res = builder.on_end_object(); res != parser_error_code::more_data_needed)
+							{ return make_result(ptr, res); }
+
+							if(builder.depth() == 0)
+							{ return make_result(ptr, parser_error_code::completed); }
+
+							current_state = after_value();
+							break;
+						}
+
+						case delimiters::value_separator:
+							current_state = parser_state::before_key;
+							break;
+
+						default:
+							return make_result(ptr, parser_error_code::illegal_delimiter);
+					}
+					break;
+
+				case parser_state::after_value_array:
+					switch(ch_in)
+					{
+						case delimiters::end_array:
+						{
+							if(auto const res = builder.on_end_array(); res != parser_error_code::more_data_needed)
+							{ return make_result(ptr, res); }
+
+							if(builder.depth() == 0)
+							{ return make_result(ptr, parser_error_code::completed); }
+
+							current_state = after_value();
+							break;
+						}
+
+						case delimiters::value_separator:
+							if(elements_only && ptr == end && builder.depth() == 1)
+							{
+								builder.on_end_array();
+								return make_result(ptr, parser_error_code::completed);
+							}
+							current_state = parser_state::value;
+							break;
+
+						default:
+							return make_result(ptr, parser_error_code::illegal_delimiter);
+					}
+					break;
+
+				default:
+					__builtin_unreachable();
+			}
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,308 @@
+//@	{"target":{"name":"fast_parser.test"}}
+
+#include "./fast_parser.hpp"
+#include "./serializer.hpp"
+
+#include <testfwk/testfwk.hpp>
+
+#include <random>
+
+namespace
+{
+	constexpr std::string_view json_test_data{R"(   {
+	"empty object": { },
+	"empty array": [ ],
+	"had": {
+		"tightly": [
+			[4, 2, 3, 1],
+			"feet",
+			true,
+			2145719840.4312375,
+			-286229488,
+			true,
+			true,
+			{"object in array": "bar"},
+			{"object with literal last" : null}
+		],
+		"sound": false,
+		"eaten": false,
+		"pull" : 1285774482.782745,
+		"long" : -1437168945.8634152,
+		"independent": -1451031326,
+		"repeated end": {
+			"value": 46
+		}
+	},
+	"fireplace": 720535269,
+	"refused": "better",
+	"wood": "involved",
+	"without": true,
+	"it": false,
+	"testing null": null,
+	"a key with \\\\\\\\ many backslashes \\\"": "A value with esc seq\n\t\\foo\"",
+	"a key with esc seq\n\t\\foo\"": "A value with esc seq\n\t\\foo\""
+}Some data after blob)"};
+
+	void expect_same_result(std::string_view data)
+	{
+		jopp::container expected_val;
+		jopp::parser parser{expected_val};
+		auto const expected = parser.parse(data);
+
+		jopp::container val;
+		jopp::fast_parser fast_parser{val};
+		auto const res = fast_parser.parse(data);
+
+		EXPECT_EQ(res.ec, expected.ec);
+		EXPECT_EQ(res.ptr, std::to_address(expected.ptr));
+		EXPECT_EQ(res.line, expected.line);
+		EXPECT_EQ(res.col, expected.col);
+		if(res.ec == jopp::parser_error_code::completed && expected.ec == jopp::parser_error_code::completed)
+		{ EXPECT_EQ(to_string(val), to_string(expected_val)); }
+	}
+
+	std::string make_random_document(std::mt19937& rng, size_t depth)
+	{
+		auto const make_string = [&rng]() {
+			std::string ret{"\""};
+			auto const length = std::uniform_int_distribution<size_t>{0, 90}(rng);
+			for(size_t k = 0; k != length; ++k)
+			{
+				switch(std::uniform_int_distribution{0, 12}(rng))
+				{
+					case 0:
+						ret.append("\\\\");
+						break;
+					case 1:
+						ret.append("\\\"");
+						break;
+					case 2:
+						ret.append("\\n");
+						break;
+					default:
+						ret += static_cast<char>(std::uniform_int_distribution{'a', 'z'}(rng));
+				}
+			}
+			ret += '"';
+			return ret;
+		};
+
+		auto const make_leaf = [&rng, &make_string]() -> std::string {
+			switch(std::uniform_int_distribution{0, 4}(rng))
+			{
+				case 0:
+					return "true";
+				case 1:
+					return "false";
+				case 2:
+					return "null";
+				case 3:
+					return std::to_string(std::uniform_real_distribution{-1.0e6, 1.0e6}(rng));
+				default:
+					return make_string();
+			}
+		};
+
+		auto const is_object = std::uniform_int_distribution{0, 1}(rng) == 0;
+		std::string ret{is_object ? "{" : "[\n"};
+		auto const n = std::uniform_int_distribution<size_t>{0, 8}(rng);
+		for(size_t k = 0; k != n; ++k)
+		{
+			if(k != 0)
+			{ ret.append(", "); }
+			if(is_object)
+			{ ret.append(make_string()).append(std::to_string(k)).append(" :\t"); }
+			if(depth != 0 && std::uniform_int_distribution{0, 3}(rng) == 0)
+			{ ret.append(make_random_document(rng, depth - 1)); }
+			else
+			{ ret.append(make_leaf()); }
+		}
+		ret.append(is_object ? "}" : "\r\n]");
+		return ret;
+	}
+}
+
+TESTCASE(jopp_fast_parser_find_escaped_chars)
+{
+	std::mt19937 rng;
+	for(size_t k = 0; k != 4096; ++k)
+	{
+		std::array<char, 3*jopp::simd::char_block::size> data{};
+		for(auto& item : data)
+		{ item = std::uniform_int_distribution{0, 2}(rng) == 0 ? 'a' : '\\'; }
+
+		std::array<bool, std::size(data)> expected{};
+		for(size_t l = 1; l != std::size(data); ++l)
+		{ expected[l] = data[l - 1] == '\\' && !expected[l - 1]; }
+
+		uint64_t prev_escaped{};
+		for(size_t block = 0; block != 3; ++block)
+		{
+			jopp::simd::char_block const chars{std::data(data) + block*jopp::simd::char_block::size};
+			auto const escaped = jopp::find_escaped_chars(chars.eq('\\'), prev_escaped);
+			for(size_t l = 0; l != jopp::simd::char_block::size; ++l)
+			{
+				EXPECT_EQ(((escaped >> l) & 1) != 0,
+					expected[block*jopp::simd::char_block::size + l]);
+			}
+		}
+	}
+}
+
+TESTCASE(jopp_fast_parser_structural_index)
+{
+	std::string_view data{R"( {"a\"{" : [1, tru,"x"]}x)"};
+	jopp::structural_index index;
+	index.build(std::span{std::data(data), std::size(data)});
+	auto cursor = index.get_cursor();
+	std::string found;
+	while(true)
+	{
+		auto const pos = cursor.next();
+		if(pos == jopp::structural_cursor::npos)
+		{ break; }
+		found += data[pos];
+	}
+	EXPECT_EQ(found, R"({":[1,t,"]}x)");
+}
+
+TESTCASE(jopp_fast_parser_parse_data)
+{
+	jopp::container val;
+	jopp::fast_parser parser{val};
+
+	auto const res = parser.parse(json_test_data);
+	EXPECT_EQ(res.ec, jopp::parser_error_code::completed);
+	EXPECT_EQ(*res.ptr, 'S');
+	EXPECT_EQ(res.line, 33);
+	EXPECT_EQ(res.col, 1);
+
+	auto const& root = val.get<jopp::object>();
+	EXPECT_EQ(std::size(root), 11);
+	EXPECT_EQ(root.get_field_as<jopp::string>("a key with \\\\\\\\ many backslashes \\\""),
+		"A value with esc seq\n\t\\foo\"");
+	expect_same_result(json_test_data);
+}
+
+TESTCASE(jopp_fast_parser_parse_data_memory_resource)
+{
+	std::pmr::monotonic_buffer_resource resource;
+	jopp::container val;
+	jopp::fast_parser parser{val, 1024, &resource};
+
+	auto const res = parser.parse(json_test_data);
+	EXPECT_EQ(res.ec, jopp::parser_error_code::completed);
+
+	auto const& root = val.get<jopp::object>();
+	EXPECT_EQ(root.get_allocator().resource(), &resource);
+	auto const& str = root.get_field_as<jopp::string>("a key with \\\\\\\\ many backslashes \\\"");
+	EXPECT_EQ(str.get_allocator().resource(), &resource);
+}
+
+TESTCASE(jopp_fast_parser_errors)
+{
+	for(auto item : std::initializer_list<std::string_view>{
+		"\"lorem ipsum\"",
+		"false ",
+		"[foobar]",
+		"{\n\t\"the key\": \"123\",\n\t\"the key\": \"124\"\n}",
+		"{\n\t\"the key\": \"123\n\"\n}",
+		R"({"the key": "123\u0000"})",
+		R"({junk"the key": "123"})",
+		"{\n\t\"the\nkey\": \"123\"}",
+		R"({"the key\u0000": "123"})",
+		R"({"the key" junk: "123"})",
+		R"({"the key": "123" junk})",
+		R"({"the key": 123 junk})",
+		R"({"the key": 123 , junk})",
+		R"(["A string" 123])",
+		R"([123 456])",
+		"{\"key a\": 456,\n\t\"key a\": {}\n}",
+		"{\"key a\": 456,\n\t\"key b\": 5687\n]",
+		"[456,\n\t5687\n}",
+		"[1\"2\"]",
+		"[1:2, 3]",
+		"{\"a\": }, 1]",
+		"{\"a\": ]",
+		"]",
+		"{\"a\": 1, \"a\": []}",
+		"[[], {}, [{}]]",
+		"[1, 2",
+		"[\"abc",
+		"[\"abc\\",
+		"[tru",
+		"",
+		"   \n  "
+	})
+	{ expect_same_result(item); }
+}
+
+TESTCASE(jopp_fast_parser_nesting_level_too_deep)
+{
+	std::string_view data{R"([456, [5687]])"};
+	jopp::container val;
+	jopp::fast_parser parser{val, 1};
+	auto res = parser.parse(data);
+	EXPECT_EQ(res.ec, jopp::parser_error_code::nesting_level_too_deep);
+	EXPECT_EQ(*res.ptr, '5');
+	EXPECT_EQ(res.line, 1);
+	EXPECT_EQ(res.col, 7);
+}
+
+TESTCASE(jopp_fast_parser_random_documents)
+{
+	std::mt19937 rng;
+	for(size_t k = 0; k != 256; ++k)
+	{
+		auto const doc = make_random_document(rng, 4);
+		expect_same_result(doc);
+
+		for(size_t l = 0; l != 8; ++l)
+		{
+			auto mutated = doc;
+			auto const pos = std::uniform_int_distribution<size_t>{0, std::size(doc) - 1}(rng);
+			constexpr std::string_view replacements{"{}[]:,\"\\ \nx1\t"};
+			mutated[pos] = replacements[std::uniform_int_distribution<size_t>{0, std::size(replacements) - 1}(rng)];
+			expect_same_result(mutated);
+		}
+	}
+}
+
+TESTCASE(jopp_fast_parser_parse_elements)
+{
+	auto const parse_elements = [](std::string_view input, jopp::container& root) {
+		return jopp::fast_parser{root}.parse_elements(std::span{std::data(input), std::size(input)});
+	};
+
+	{
+		std::string_view input{" 1, [2, 3], {\"a\": \"b, c\"},"};
+		jopp::container root;
+		auto const res = parse_elements(input, root);
+		EXPECT_EQ(res.ec, jopp::parser_error_code::completed);
+		EXPECT_EQ(res.ptr, std::data(input) + std::size(input));
+		EXPECT_EQ(std::size(root.get<jopp::array>()), 3);
+	}
+
+	{
+		std::string_view input{"1, 2] trailing"};
+		jopp::container root;
+		auto const res = parse_elements(input, root);
+		EXPECT_EQ(res.ec, jopp::parser_error_code::completed);
+		EXPECT_EQ(res.ptr, std::data(input) + 5);
+		EXPECT_EQ(std::size(root.get<jopp::array>()), 2);
+	}
+
+	{
+		// The last comma is inside a string
+		std::string_view input{"1, \"2,"};
+		jopp::container root;
+		EXPECT_EQ(parse_elements(input, root).ec, jopp::parser_error_code::more_data_needed);
+	}
+
+	{
+		// The last comma is inside a nested array
+		std::string_view input{"1, [2,"};
+		jopp::container root;
+		EXPECT_EQ(parse_elements(input, root).ec, jopp::parser_error_code::more_data_needed);
+	}
+}
@@ -0,0 +1,646 @@
+#ifndef JOPP_FILTERED_PARSER_HPP
+#define JOPP_FILTERED_PARSER_HPP
+
+#include "./fast_parser.hpp"
+
+#include <charconv>
+#include <initializer_list>
+#include <stdexcept>
+
+namespace jopp::inline JOPP_OBJECT_STORAGE_NAMESPACE
+{
+	class invalid_json_pointer_error:public std::runtime_error
+	{
+	public:
+		explicit invalid_json_pointer_error(std::string_view path):
+			runtime_error{std::string{"`"}.append(path).append("` is not a valid JSON pointer")}
+		{}
+	};
+
+	// A set of JSON pointers, stored as a tree of path segments. In addition to RFC 6901, the segment
+	// * matches any key or array index. A segment that matches exactly takes precedence over *.
+	class path_filter
+	{
+	public:
+		static constexpr size_t root = 0;
+
+		path_filter():m_nodes(1), m_required{0}, m_has_wildcard{false}
+		{}
+
+		explicit path_filter(std::initializer_list<std::string_view> paths):path_filter{}
+		{
+			for(auto const& item : paths)
+			{ add(item); }
+		}
+
+		void add(std::string_view path)
+		{
+			if(!path.empty() && path.front() != '/')
+			{ throw invalid_json_pointer_error{path}; }
+
+			size_t node = root;
+			auto wildcard = false;
+			auto under_selected = false;
+			auto remaining = path;
+			while(!remaining.empty())
+			{
+				under_selected = under_selected || m_nodes[node].selected;
+				remaining.remove_prefix(1);
+				auto const segment = remaining.substr(0, remaining.find('/'));
+				remaining.remove_prefix(std::size(segment));
+				if(segment == "*")
+				{
+					wildcard = true;
+					node = get_or_add_wildcard(node);
+				}
+				else
+				{ node = get_or_add_child(node, unescape_segment(path, segment)); }
+			}
+
+			m_has_wildcard = m_has_wildcard || wildcard;
+			if(m_nodes[node].selected || under_selected)
+			{
+				m_nodes[node].selected = true;
+				return;
+			}
+
+			// A selected node is parsed as a whole, so paths below it are never visited on their own
+			uncount_below(node);
+			m_nodes[node].selected = true;
+			m_nodes[node].required = !wildcard;
+			m_required += wildcard ? 0 : 1;
+		}
+
+		std::optional<size_t> find_child(size_t node, std::string_view key) const
+		{
+			auto const& children = m_nodes[node].children;
+			auto const i = std::ranges::find(children, key, &std::pair<std::string, size_t>::first);
+			if(i != std::end(children))
+			{ return i->second; }
+			return m_nodes[node].wildcard;
+		}
+
+		std::optional<size_t> find_child(size_t node, size_t index) const
+		{
+			std::array<char, 24> buffer{};
+			auto const res = std::to_chars(std::data(buffer), std::data(buffer) + std::size(buffer), index);
+			return find_child(node, std::string_view{std::data(buffer), res.ptr});
+		}
+
+		bool selected(size_t node) const
+		{ return m_nodes[node].selected; }
+
+		// The number of paths without wildcards. When all of them have been seen, there is nothing
+		// more to look for.
+		size_t required_count() const
+		{ return m_required; }
+
+		bool has_wildcard() const
+		{ return m_has_wildcard; }
+
+	private:
+		struct node
+		{
+			std::vector<std::pair<std::string, size_t>> children;
+			std::optional<size_t> wildcard;
+			bool selected{false};
+			bool required{false};
+		};
+
+		void uncount_below(size_t node)
+		{
+			auto const uncount = [this](size_t child) {
+				if(std::exchange(m_nodes[child].required, false))
+				{ --m_required; }
+				uncount_below(child);
+			};
+
+			for(auto const& item : m_nodes[node].children)
+			{ uncount(item.second); }
+			if(m_nodes[node].wildcard.has_value())
+			{ uncount(*m_nodes[node].wildcard); }
+		}
+
+		static std::string unescape_segment(std::string_view path, std::string_view segment)
+		{
+			std::string ret;
+			for(size_t k = 0; k != std::size(segment); ++k)
+			{
+				if(segment[k] != '~')
+				{
+					ret += segment[k];
+					continue;
+				}
+
+				if(k + 1 == std::size(segment) || (segment[k + 1] != '0' && segment[k + 1] != '1'))
+				{ throw invalid_json_pointer_error{path}; }
+				ret += segment[k + 1] == '0' ? '~' : '/';
+				++k;
+			}
+			return ret;
+		}
+
+		size_t get_or_add_child(size_t parent, std::string&& key)
+		{
+			auto& children = m_nodes[parent].children;
+			auto const i = std::ranges::find(children, key, &std::pair<std::string, size_t>::first);
+			if(i != std::end(children))
+			{ return i->second; }
+
+			auto const ret = std::size(m_nodes);
+			children.emplace_back(std::move(key), ret);
+			m_nodes.emplace_back();
+			return ret;
+		}
+
+		size_t get_or_add_wildcard(size_t parent)
+		{
+			if(m_nodes[parent].wildcard.has_value())
+			{ return *m_nodes[parent].wildcard; }
+
+			auto const ret = std::size(m_nodes);
+			m_nodes[parent].wildcard = ret;
+			m_nodes.emplace_back();
+			return ret;
+		}
+
+		std::vector<node> m_nodes;
+		size_t m_required;
+		bool m_has_wildcard;
+	};
+
+	// Like decode_string, but without storing the string anywhere
+	inline decode_result skip_string(char const* ptr, char const* end)
+	{
+		while(true)
+		{
+			ptr = find_char_to_escape(ptr, end);
+			if(ptr == end)
+			{ return decode_result{end, parser_error_code::more_data_needed}; }
+
+			switch(*ptr)
+			{
+				case delimiters::string_begin_end:
+					return decode_result{ptr + 1, parser_error_code::completed};
+
+				case begin_esc_seq:
+					if(end - ptr < 2)
+					{ return decode_result{end, parser_error_code::more_data_needed}; }
+					ptr += 2;
+					break;
+
+				default:
+					return decode_result{ptr + 1, parser_error_code::character_must_be_escaped};
+			}
+		}
+	}
+
+	// The kinds of the open brackets in a skipped container, one bit per level. Only containers
+	// nested deeper than 64 levels allocate.
+	class bracket_stack
+	{
+	public:
+		bracket_stack():m_bits{0}, m_size{0}
+		{}
+
+		void push(char bracket)
+		{
+			if(m_size != 0 && m_size % 64 == 0)
+			{
+				m_overflow.push_back(m_bits);
+				m_bits = 0;
+			}
+			m_bits = (m_bits << 1) | (bracket == delimiters::begin_array ? 1u : 0u);
+			++m_size;
+		}
+
+		// Removes the innermost bracket, and returns the bracket that closes it
+		char pop()
+		{
+			auto const ret = (m_bits & 1) != 0 ? delimiters::end_array : delimiters::end_object;
+			m_bits >>= 1;
+			--m_size;
+			if(m_size != 0 && m_size % 64 == 0)
+			{
+				m_bits = m_overflow.back();
+				m_overflow.pop_back();
+			}
+			return ret;
+		}
+
+		bool empty() const
+		{ return m_size == 0; }
+
+	private:
+		uint64_t m_bits;
+		size_t m_size;
+		std::vector<uint64_t> m_overflow;
+	};
+
+	// Returns a pointer past the container that begins at ptr. Only brackets and quotes are
+	// checked, so that a skipped container is never decoded.
+	inline decode_result skip_container(char const* ptr, char const* end)
+	{
+		bracket_stack open_brackets;
+		while(true)
+		{
+			while(end - ptr >= static_cast<ptrdiff_t>(simd::char_block::size))
+			{
+				simd::char_block const block{ptr};
+				auto const mask = block.eq(delimiters::string_begin_end)
+					| block.eq(delimiters::begin_array) | block.eq(delimiters::end_array)
+					| block.eq(delimiters::begin_object) | block.eq(delimiters::end_object);
+				if(mask != 0)
+				{
+					ptr += std::countr_zero(mask);
+					break;
+				}
+				ptr += simd::char_block::size;
+			}
+
+			ptr = std::find_if(ptr, end, [](char ch) {
+				return ch == delimiters::string_begin_end
+					|| ch == delimiters::begin_array || ch == delimiters::end_array
+					|| ch == delimiters::begin_object || ch == delimiters::end_object;
+			});
+			if(ptr == end)
+			{ return decode_result{end, parser_error_code::more_data_needed}; }
+
+			switch(*ptr)
+			{
+				case delimiters::string_begin_end:
+				{
+					auto const res = skip_string(ptr + 1, end);
+					if(res.ec != parser_error_code::completed)
+					{ return res; }
+					ptr = res.ptr;
+					break;
+				}
+
+				case delimiters::begin_array:
+				case delimiters::begin_object:
+					open_brackets.push(*ptr);
+					++ptr;
+					break;
+
+				default:
+					if(open_brackets.pop() != *ptr)
+					{ return decode_result{ptr + 1, parser_error_code::illegal_delimiter}; }
+					++ptr;
+					if(open_brackets.empty())
+					{ return decode_result{ptr, parser_error_code::completed}; }
+			}
+		}
+	}
+
+	// Parses only the parts of the input that are selected by a path_filter. Containers on the
+	// way to a selected value are kept, and selected object fields keep their keys. Array elements
+	// that are skipped are left out of the output, so the indices of the elements after them
+	// shift: with the filter {"/items/2"}, the selected element ends up at /items/0. All other
+	// values are skipped with a scan that does not decode them. Brackets, quotes and separators
+	// around skipped values are checked, but their contents are not validated, so a misspelled
+	// literal or a missing comma inside a skipped container goes unnoticed.
+	//
+	// When the filter has no wildcards, parsing stops as soon as all paths have been seen. The
+	// rest of the input is then not looked at, and ptr in the result is after the last selected
+	// value.
+	class filtered_parser
+	{
+	public:
+		explicit filtered_parser(container& root,
+			path_filter const& filter,
+			std::optional<size_t> max_levels = 1024,
+			std::pmr::memory_resource* resource = std::pmr::get_default_resource()):
+			m_root{root},
+			m_filter{filter},
+			m_max_levels{max_levels},
+			m_resource{resource},
+			m_begin{nullptr},
+			m_end{nullptr},
+			m_remaining{0},
+			m_stopped{false}
+		{}
+
+		parse_result<char const*> parse(std::string_view input);
+
+		container const& root() const
+		{ return m_root; }
+
+	private:
+		struct selected_value_policy
+		{
+			static constexpr bool track_position = false;
+			static constexpr bool limit_depth = true;
+			static constexpr bool reject_duplicate_keys = true;
+		};
+
+		char const* skip_whitespace(char const* ptr) const
+		{ return std::find_if_not(ptr, m_end, is_whitespace); }
+
+		decode_result skip_value(char const* ptr) const;
+
+		template<class Store>
+		decode_result parse_selected(char const* ptr, size_t depth, Store&& store);
+
+		template<class Store>
+		decode_result parse_child(char const* ptr, std::optional<size_t> node, size_t depth, Store&& store);
+
+		decode_result parse_object(char const* ptr, size_t node, object& output, size_t depth);
+
+		decode_result parse_array(char const* ptr, size_t node, array& output, size_t depth);
+
+		std::reference_wrapper<container> m_root;
+		path_filter const& m_filter;
+		std::optional<size_t> m_max_levels;
+		std::pmr::memory_resource* m_resource;
+		char const* m_begin;
+		char const* m_end;
+		size_t m_remaining;
+		bool m_stopped;
+		string m_key;
+	};
+}
+
+inline jopp::decode_result jopp::filtered_parser::skip_value(char const* ptr) const
+{
+	switch(*ptr)
+	{
+		case delimiters::begin_array:
+		case delimiters::begin_object:
+			return skip_container(ptr, m_end);
+
+		case delimiters::string_begin_end:
+			return skip_string(ptr + 1, m_end);
+
+		default:
+		{
+			auto const literal_end = find_literal_end(ptr, m_end);
+			if(literal_end == ptr || *ptr == delimiters::name_separator)
+			{ return decode_result{ptr + 1, parser_error_code::illegal_delimiter}; }
+			if(literal_end == m_end)
+			{ return decode_result{m_end, parser_error_code::more_data_needed}; }
+			return decode_result{literal_end, parser_error_code::completed};
+		}
+	}
+}
+
+template<class Store>
+jopp::decode_result jopp::filtered_parser::parse_selected(char const* ptr, size_t depth, Store&& store)
+{
+	decode_result res{};
+	value val;
+	switch(*ptr)
+	{
+		case delimiters::begin_array:
+		case delimiters::begin_object:
+		{
+			// Building the tree dominates here, and basic_parser does that at least as fast as
+			// fast_parser, without the extra pass that finds the end of the container
+			container item;
+			auto const max_levels = m_max_levels.has_value() ?
+				std::optional{*m_max_levels - std::min(depth, *m_max_levels)} :
+				std::nullopt;
+			basic_parser<selected_value_policy> parser{item, max_levels, m_resource};
+			auto const parse_res = parser.parse(std::span{ptr, m_end});
+			res = decode_result{std::to_address(parse_res.ptr), parse_res.ec};
+			val = to_value(std::move(item));
+			break;
+		}
+
+		case delimiters::string_begin_end:
+		{
+			string str{m_resource};
+			res = decode_string(ptr + 1, m_end, str);
+			val = value{std::move(str)};
+			break;
+		}
+
+		default:
+		{
+			auto const literal_end = find_literal_end(ptr, m_end);
+			if(literal_end == m_end)
+			{ return decode_result{m_end, parser_error_code::more_data_needed}; }
+
+			auto literal = make_value(std::string_view{ptr, literal_end});
+			if(!literal.has_value())
+			{ return decode_result{literal_end + 1, parser_error_code::invalid_value}; }
+			res = decode_result{literal_end, parser_error_code::completed};
+			val = std::move(*literal);
+		}
+	}
+
+	if(res.ec != parser_error_code::completed)
+	{ return res; }
+
+	if(!store(std::move(val)))
+	{ return decode_result{res.ptr, parser_error_code::key_already_exists}; }
+
+	return res;
+}
+
+template<class Store>
+jopp::decode_result jopp::filtered_parser::parse_child(char const* ptr,
+	std::optional<size_t> node,
+	size_t depth,
+	Store&& store)
+{
+	if(!node.has_value())
+	{ return skip_value(ptr); }
+
+	if(m_filter.selected(*node))
+	{
+		auto const res = parse_selected(ptr, depth, store);
+		if(res.ec == parser_error_code::completed && !m_filter.has_wildcard())
+		{
+			--m_remaining;
+			m_stopped = m_remaining == 0;
+		}
+		return res;
+	}
+
+	if(m_max_levels.has_value() && depth == *m_max_levels
+		&& (*ptr == delimiters::begin_object || *ptr == delimiters::begin_array))
+	{ return decode_result{ptr + 1, parser_error_code::nesting_level_too_deep}; }
+
+	switch(*ptr)
+	{
+		case delimiters::begin_object:
+		{
+			value val{object{m_resource}};
+			auto const obj = val.get_if<object>();
+			if(!store(std::move(val)))
+			{ return decode_result{ptr + 1, parser_error_code::key_already_exists}; }
+			return parse_object(ptr, *node, *obj, depth + 1);
+		}
+
+		case delimiters::begin_array:
+		{
+			value val{array{m_resource}};
+			auto const arr = val.get_if<array>();
+			if(!store(std::move(val)))
+			{ return decode_result{ptr + 1, parser_error_code::key_already_exists}; }
+			return parse_array(ptr, *node, *arr, depth + 1);
+		}
+
+		default:
+			return skip_value(ptr);
+	}
+}
+
+inline jopp::decode_result jopp::filtered_parser::parse_object(char const* ptr,
+	size_t node,
+	object& output,
+	size_t depth)
+{
+	ptr = skip_whitespace(ptr + 1);
+	if(ptr != m_end && *ptr == delimiters::end_object)
+	{ return decode_result{ptr + 1, parser_error_code::completed}; }
+
+	while(true)
+	{
+		if(ptr == m_end)
+		{ return decode_result{m_end, parser_error_code::more_data_needed}; }
+		if(*ptr != delimiters::string_begin_end)
+		{ return decode_result{ptr + 1, parser_error_code::illegal_delimiter}; }
+
+		// Most keys have no escape sequences, and can be matched without copying them
+		std::string_view key;
+		auto const key_end = find_char_to_escape(ptr + 1, m_end);
+		if(key_end != m_end && *key_end == delimiters::string_begin_end)
+		{
+			key = std::string_view{ptr + 1, key_end};
+			ptr = key_end + 1;
+		}
+		else
+		{
+			m_key.clear();
+			auto const res = decode_string(ptr + 1, m_end, m_key);
+			if(res.ec != parser_error_code::completed)
+			{ return res; }
+			key = m_key;
+			ptr = res.ptr;
+		}
+
+		ptr = skip_whitespace(ptr);
+		if(ptr == m_end)
+		{ return decode_result{m_end, parser_error_code::more_data_needed}; }
+		if(*ptr != delimiters::name_separator)
+		{ return decode_result{ptr + 1, parser_error_code::illegal_delimiter}; }
+
+		ptr = skip_whitespace(ptr + 1);
+		if(ptr == m_end)
+		{ return decode_result{m_end, parser_error_code::more_data_needed}; }
+
+		auto const res = parse_child(ptr, m_filter.find_child(node, key), depth, [&output, key](value&& val) {
+			return output.insert(key, std::move(val)).second;
+		});
+		if(res.ec != parser_error_code::completed || m_stopped)
+		{ return res; }
+
+		ptr = skip_whitespace(res.ptr);
+		if(ptr == m_end)
+		{ return decode_result{m_end, parser_error_code::more_data_needed}; }
+
+		switch(*ptr)
+		{
+			case delimiters::end_object:
+				return decode_result{ptr + 1, parser_error_code::completed};
+
+			case delimiters::value_separator:
+				ptr = skip_whitespace(ptr + 1);
+				break;
+
+			default:
+				return decode_result{ptr + 1, parser_error_code::illegal_delimiter};
+		}
+	}
+}
+
+inline jopp::decode_result jopp::filtered_parser::parse_array(char const* ptr,
+	size_t node,
+	array& output,
+	size_t depth)
+{
+	ptr = skip_whitespace(ptr + 1);
+	if(ptr != m_end && *ptr == delimiters::end_array)
+	{ return decode_result{ptr + 1, parser_error_code::completed}; }
+
+	size_t index = 0;
+	while(true)
+	{
+		if(ptr == m_end)
+		{ return decode_result{m_end, parser_error_code::more_data_needed}; }
+
+		auto const res = parse_child(ptr, m_filter.find_child(node, index), depth, [&output](value&& val) {
+			output.push_back(std::move(val));
+			return true;
+		});
+		if(res.ec != parser_error_code::completed || m_stopped)
+		{ return res; }
+
+		ptr = skip_whitespace(res.ptr);
+		if(ptr == m_end)
+		{ return decode_result{m_end, parser_error_code::more_data_needed}; }
+
+		switch(*ptr)
+		{
+			case delimiters::end_array:
+				return decode_result{ptr + 1, parser_error_code::completed};
+
+			case delimiters::value_separator:
+				ptr = skip_whitespace(ptr + 1);
+				++index;
+				break;
+
+			default:
+				return decode_result{ptr + 1, parser_error_code::illegal_delimiter};
+		}
+	}
+}
+
+inline jopp::parse_result<char const*> jopp::filtered_parser::parse(std::string_view input)
+{
+	m_begin = std::data(input);
+	m_end = m_begin + std::size(input);
+	m_remaining = m_filter.required_count();
+	m_stopped = false;
+
+	auto const make_result = [begin = m_begin](char const* ptr, parser_error_code ec) {
+		auto const pos = get_text_position(begin, ptr - 1);
+		return parse_result{ptr, ec, pos.line, pos.col};
+	};
+
+	auto const ptr = skip_whitespace(m_begin);
+	if(ptr == m_end)
+	{
+		auto const pos = get_text_position(m_begin, m_end);
+		return parse_result{m_end, parser_error_code::more_data_needed, pos.line, pos.col};
+	}
+
+	if(*ptr != delimiters::begin_object && *ptr != delimiters::begin_array)
+	{ return make_result(ptr + 1, parser_error_code::no_top_level_node); }
+
+	if(m_filter.selected(path_filter::root))
+	{
+		auto const res = parse_selected(ptr, 0, [this](value&& val) {
+			m_root.get() = val.get_if<object>() != nullptr ?
+				container{std::move(*val.get_if<object>())} :
+				container{std::move(*val.get_if<array>())};
+			return true;
+		});
+		return make_result(res.ptr, res.ec);
+	}
+
+	if(*ptr == delimiters::begin_object)
+	{
+		m_root.get() = container{object{m_resource}};
+		auto const res = parse_object(ptr, path_filter::root, *m_root.get().get_if<object>(), 1);
+		return make_result(res.ptr, res.ec);
+	}
+
+	m_root.get() = container{array{m_resource}};
+	auto const res = parse_array(ptr, path_filter::root, *m_root.get().get_if<array>(), 1);
+	return make_result(res.ptr, res.ec);
+}
+
+#endif
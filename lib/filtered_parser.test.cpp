@@ -0,0 +1,267 @@
+//@	{"target":{"name":"filtered_parser.test"}}
+
+#include "./filtered_parser.hpp"
+
+#include <testfwk/testfwk.hpp>
+
+namespace
+{
+	constexpr std::string_view document{R"({
+	"meta": {"id": 42, "name": "Order", "extra": {"a": [1, 2, {"b": "}]\"{["}]}},
+	"items": [
+		{"name": "Pen", "price": 1.5, "tags": ["office"]},
+		{"name": "Paper", "price": 4.25},
+		{"name": "Stapler"}
+	],
+	"notes": "A\tlong text with \"quotes\" and [brackets]",
+	"customer": {"name": "Someone", "address": {"city": "Somewhere"}}
+}
+trailing)"};
+}
+
+TESTCASE(jopp_path_filter)
+{
+	jopp::path_filter const filter{"/meta/id", "/items/*/price", "/a~1b/c~0d", "/items/0"};
+	EXPECT_EQ(filter.required_count(), 3);
+	EXPECT_EQ(filter.has_wildcard(), true);
+
+	auto const meta = filter.find_child(jopp::path_filter::root, "meta");
+	REQUIRE_EQ(meta.has_value(), true);
+	EXPECT_EQ(filter.selected(*meta), false);
+	EXPECT_EQ(filter.selected(filter.find_child(*meta, "id").value()), true);
+	EXPECT_EQ(filter.find_child(*meta, "name").has_value(), false);
+
+	auto const slashed = filter.find_child(jopp::path_filter::root, "a/b");
+	REQUIRE_EQ(slashed.has_value(), true);
+	EXPECT_EQ(filter.selected(filter.find_child(*slashed, "c~d").value()), true);
+
+	auto const items = filter.find_child(jopp::path_filter::root, "items").value();
+	EXPECT_EQ(filter.selected(filter.find_child(items, size_t{0}).value()), true);
+	auto const other = filter.find_child(items, size_t{5});
+	REQUIRE_EQ(other.has_value(), true);
+	EXPECT_EQ(filter.selected(*other), false);
+	EXPECT_EQ(filter.selected(filter.find_child(*other, "price").value()), true);
+
+	try
+	{
+		jopp::path_filter{"meta/id"};
+		EXPECT_EQ(true, false);
+	}
+	catch(jopp::invalid_json_pointer_error const&)
+	{}
+
+	try
+	{
+		jopp::path_filter{"/meta~2"};
+		EXPECT_EQ(true, false);
+	}
+	catch(jopp::invalid_json_pointer_error const&)
+	{}
+}
+
+TESTCASE(jopp_path_filter_nested_paths)
+{
+	EXPECT_EQ((jopp::path_filter{"/a", "/a/b"}.required_count()), 1);
+	EXPECT_EQ((jopp::path_filter{"/a/b", "/a/c/d", "/a"}.required_count()), 1);
+	EXPECT_EQ((jopp::path_filter{"/a/b", "/a/c", "/a/b"}.required_count()), 2);
+	EXPECT_EQ((jopp::path_filter{"/a/b", ""}.required_count()), 1);
+	EXPECT_EQ((jopp::path_filter{"/a/*/c", "/a"}.required_count()), 1);
+}
+
+TESTCASE(jopp_filtered_parser_stops_early_with_nested_paths)
+{
+	jopp::path_filter const filter{"/meta/extra/a", "/meta"};
+	jopp::container root;
+	auto const res = jopp::filtered_parser{root, filter}.parse(document.substr(0, 100));
+	EXPECT_EQ(res.ec, jopp::parser_error_code::completed);
+	EXPECT_EQ(*(res.ptr - 1), '}');
+	auto const& meta = root.get<jopp::object>().get_field_as<jopp::object>("meta");
+	EXPECT_EQ(meta.get_field_as<jopp::number>("id"), 42.0);
+}
+
+TESTCASE(jopp_filtered_parser_wildcard)
+{
+	jopp::path_filter const filter{"/meta/id", "/items/*/price", "/customer/address"};
+	jopp::container root;
+	auto const res = jopp::filtered_parser{root, filter}.parse(document);
+	EXPECT_EQ(res.ec, jopp::parser_error_code::completed);
+	EXPECT_EQ(res.ptr, std::end(document) - 9);
+	EXPECT_EQ(res.line, 10);
+	EXPECT_EQ(res.col, 1);
+
+	auto const& obj = root.get<jopp::object>();
+	EXPECT_EQ(std::size(obj), 3);
+	auto const& meta = obj.get_field_as<jopp::object>("meta");
+	EXPECT_EQ(std::size(meta), 1);
+	EXPECT_EQ(meta.get_field_as<jopp::number>("id"), 42.0);
+
+	auto const& items = obj.get_field_as<jopp::array>("items");
+	REQUIRE_EQ(std::size(items), 3);
+	EXPECT_EQ(items[0].get<jopp::object>().get_field_as<jopp::number>("price"), 1.5);
+	EXPECT_EQ(items[1].get<jopp::object>().get_field_as<jopp::number>("price"), 4.25);
+	EXPECT_EQ(std::size(items[2].get<jopp::object>()), 0);
+
+	auto const& address = obj.get_field_as<jopp::object>("customer").get_field_as<jopp::object>("address");
+	EXPECT_EQ(address.get_field_as<jopp::string>("city"), "Somewhere");
+}
+
+TESTCASE(jopp_filtered_parser_stops_early)
+{
+	jopp::path_filter const filter{"/meta/extra", "/items/1/name"};
+	jopp::container root;
+	auto const res = jopp::filtered_parser{root, filter}.parse(document.substr(0, 200));
+	EXPECT_EQ(res.ec, jopp::parser_error_code::completed);
+	EXPECT_EQ(*(res.ptr - 1), '"');
+	EXPECT_EQ(res.line, 5);
+
+	auto const& obj = root.get<jopp::object>();
+	auto const& extra = obj.get_field_as<jopp::object>("meta").get_field_as<jopp::object>("extra");
+	auto const& a = extra.get_field_as<jopp::array>("a");
+	REQUIRE_EQ(std::size(a), 3);
+	EXPECT_EQ(a[2].get<jopp::object>().get_field_as<jopp::string>("b"), "}]\"{[");
+
+	auto const& items = obj.get_field_as<jopp::array>("items");
+	REQUIRE_EQ(std::size(items), 1);
+	EXPECT_EQ(items[0].get<jopp::object>().get_field_as<jopp::string>("name"), "Paper");
+}
+
+TESTCASE(jopp_filtered_parser_skipped_elements_shift_indices)
+{
+	jopp::path_filter const filter{"/items/0/name", "/items/2", "/meta/extra/a/2"};
+	jopp::container root;
+	auto const res = jopp::filtered_parser{root, filter}.parse(document);
+	EXPECT_EQ(res.ec, jopp::parser_error_code::completed);
+
+	auto const& obj = root.get<jopp::object>();
+	auto const& items = obj.get_field_as<jopp::array>("items");
+	REQUIRE_EQ(std::size(items), 2);
+	EXPECT_EQ(items[0].get<jopp::object>().get_field_as<jopp::string>("name"), "Pen");
+	EXPECT_EQ(items[1].get<jopp::object>().get_field_as<jopp::string>("name"), "Stapler");
+
+	auto const& a = obj.get_field_as<jopp::object>("meta")
+		.get_field_as<jopp::object>("extra")
+		.get_field_as<jopp::array>("a");
+	REQUIRE_EQ(std::size(a), 1);
+	EXPECT_EQ(a[0].get<jopp::object>().get_field_as<jopp::string>("b"), "}]\"{[");
+}
+
+TESTCASE(jopp_filtered_parser_whole_document)
+{
+	jopp::path_filter const filter{""};
+	jopp::container root;
+	auto const res = jopp::filtered_parser{root, filter}.parse(document);
+	EXPECT_EQ(res.ec, jopp::parser_error_code::completed);
+	EXPECT_EQ(std::size(root.get<jopp::object>()), 4);
+}
+
+TESTCASE(jopp_filtered_parser_errors)
+{
+	jopp::path_filter const filter{"/items/*/price"};
+	{
+		jopp::container root;
+		auto const res = jopp::filtered_parser{root, filter}.parse(document.substr(0, 100));
+		EXPECT_EQ(res.ec, jopp::parser_error_code::more_data_needed);
+	}
+
+	{
+		jopp::container root;
+		auto const res = jopp::filtered_parser{root, filter}.parse(R"({"skipped": "a)" "\n" R"(b"})");
+		EXPECT_EQ(res.ec, jopp::parser_error_code::character_must_be_escaped);
+		EXPECT_EQ(res.line, 1);
+		EXPECT_EQ(res.col, 15);
+	}
+
+	{
+		jopp::container root;
+		auto const res = jopp::filtered_parser{root, filter}.parse(R"({"items": [{"price": nope}]})");
+		EXPECT_EQ(res.ec, jopp::parser_error_code::invalid_value);
+	}
+
+	{
+		jopp::container root;
+		auto const res = jopp::filtered_parser{root, filter}.parse(R"({"items": [{"price": 1, "price": 2}]})");
+		EXPECT_EQ(res.ec, jopp::parser_error_code::key_already_exists);
+	}
+
+	{
+		jopp::container root;
+		auto const res = jopp::filtered_parser{root, filter}.parse(R"({"items" [1]})");
+		EXPECT_EQ(res.ec, jopp::parser_error_code::illegal_delimiter);
+		EXPECT_EQ(res.col, 10);
+	}
+
+	{
+		jopp::container root;
+		auto const res = jopp::filtered_parser{root, filter}.parse(R"("items")");
+		EXPECT_EQ(res.ec, jopp::parser_error_code::no_top_level_node);
+	}
+
+	{
+		jopp::container root;
+		auto const res = jopp::filtered_parser{root, filter, 2}.parse(R"({"items": [{"price": [1]}]})");
+		EXPECT_EQ(res.ec, jopp::parser_error_code::nesting_level_too_deep);
+	}
+
+	jopp::path_filter const selects_container{"/items"};
+	{
+		jopp::container root;
+		auto const res = jopp::filtered_parser{root, selects_container}.parse(R"({"items": [1, nope]})");
+		EXPECT_EQ(res.ec, jopp::parser_error_code::invalid_value);
+		EXPECT_EQ(res.col, 19);
+	}
+
+	{
+		jopp::container root;
+		auto const res = jopp::filtered_parser{root, selects_container}.parse(R"({"items": [{"a": 1, "a": 2}]})");
+		EXPECT_EQ(res.ec, jopp::parser_error_code::key_already_exists);
+	}
+
+	{
+		jopp::container root;
+		auto const res = jopp::filtered_parser{root, selects_container, 2}.parse(R"({"items": [1, [2]]})");
+		EXPECT_EQ(res.ec, jopp::parser_error_code::nesting_level_too_deep);
+		EXPECT_EQ(res.col, 15);
+	}
+
+	{
+		jopp::container root;
+		auto const res = jopp::filtered_parser{root, selects_container, 3}.parse(R"({"items": [1, [2]]})");
+		EXPECT_EQ(res.ec, jopp::parser_error_code::completed);
+	}
+}
+
+TESTCASE(jopp_filtered_parser_broken_structure_in_skipped_values)
+{
+	jopp::path_filter const filter{"/b"};
+	for(auto input : {R"({"a":,"b":1})", R"({"a":})", R"([,,])", R"({"a":[}, "b":2})", R"({"a"::1, "b":2})",
+		R"({"a":{"c":[1, {"d": 2]}}, "b":2})"})
+	{
+		jopp::container root;
+		auto const res = jopp::filtered_parser{root, filter}.parse(input);
+		EXPECT_EQ(res.ec, jopp::parser_error_code::illegal_delimiter);
+	}
+
+	jopp::container root;
+	auto const res = jopp::filtered_parser{root, filter}.parse(R"({"a":[}, "b":2})");
+	EXPECT_EQ(res.col, 7);
+}
+
+TESTCASE(jopp_filtered_parser_skips_deeply_nested_containers)
+{
+	std::string input{"{\"a\": "};
+	input.append(100, '[').append("{}").append(100, ']').append(", \"b\": 1}");
+	jopp::path_filter const filter{"/b"};
+	{
+		jopp::container root;
+		auto const res = jopp::filtered_parser{root, filter}.parse(input);
+		EXPECT_EQ(res.ec, jopp::parser_error_code::completed);
+		EXPECT_EQ(root.get<jopp::object>().get_field_as<jopp::number>("b"), 1.0);
+	}
+
+	input[100] = '{';
+	{
+		jopp::container root;
+		auto const res = jopp::filtered_parser{root, filter}.parse(input);
+		EXPECT_EQ(res.ec, jopp::parser_error_code::illegal_delimiter);
+	}
+}
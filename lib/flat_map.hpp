@@ -0,0 +1,133 @@
+#ifndef JOPP_FLAT_MAP_HPP
+#define JOPP_FLAT_MAP_HPP
+
+#include "./const_key_iterator.hpp"
+
+#include <vector>
+#include <memory_resource>
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+namespace jopp
+{
+	// A map backed by a sorted vector. Items added with append are unordered until sort_unique
+	template<class Key, class T, class Compare = std::less<>>
+	class flat_map
+	{
+	public:
+		using key_type = Key;
+		using mapped_type = T;
+		using value_type = std::pair<key_type const, mapped_type>;
+		using allocator_type = std::pmr::polymorphic_allocator<value_type>;
+		using storage_type = std::pmr::vector<std::pair<key_type, mapped_type>>;
+		using iterator = const_key_iterator<typename storage_type::iterator>;
+		using const_iterator = const_key_iterator<typename storage_type::const_iterator>;
+
+		flat_map() = default;
+
+		explicit flat_map(allocator_type alloc):m_values{alloc}
+		{}
+
+		auto get_allocator() const
+		{ return m_values.get_allocator(); }
+
+		auto begin() const
+		{ return const_iterator{std::begin(m_values)}; }
+
+		auto end() const
+		{ return const_iterator{std::end(m_values)}; }
+
+		auto begin()
+		{ return iterator{std::begin(m_values)}; }
+
+		auto end()
+		{ return iterator{std::end(m_values)}; }
+
+		auto size() const
+		{ return std::size(m_values); }
+
+		bool empty() const
+		{ return m_values.empty(); }
+
+		template<class K>
+		const_iterator find(K const& key) const
+		{
+			auto const i = lower_bound(key);
+			return const_iterator{i != std::end(m_values) && !Compare{}(key, i->first) ? i : std::end(m_values)};
+		}
+
+		template<class K>
+		iterator find(K const& key)
+		{
+			auto const i = lower_bound(key);
+			return iterator{i != std::end(m_values) && !Compare{}(key, i->first) ? i : std::end(m_values)};
+		}
+
+		template<class K>
+		bool contains(K const& key) const
+		{ return find(key) != end(); }
+
+		std::pair<iterator, bool> insert(std::pair<key_type, mapped_type>&& item)
+		{
+			auto const i = lower_bound(item.first);
+			if(i != std::end(m_values) && !Compare{}(item.first, i->first))
+			{ return std::pair{iterator{i}, false}; }
+
+			return std::pair{iterator{m_values.insert(i, std::move(item))}, true};
+		}
+
+		template<class M>
+		std::pair<iterator, bool> insert_or_assign(key_type&& key, M&& val)
+		{
+			auto const i = lower_bound(key);
+			if(i != std::end(m_values) && !Compare{}(key, i->first))
+			{
+				i->second = std::forward<M>(val);
+				return std::pair{iterator{i}, false};
+			}
+
+			return std::pair{iterator{m_values.emplace(i, std::move(key), std::forward<M>(val))}, true};
+		}
+
+		void append(std::pair<key_type, mapped_type>&& item)
+		{ m_values.push_back(std::move(item)); }
+
+		// Returns false if any key occurs more than once
+		bool sort_unique()
+		{
+			auto const compare_keys = [](auto const& a, auto const& b) {
+				return Compare{}(a.first, b.first);
+			};
+
+			if(!std::is_sorted(std::begin(m_values), std::end(m_values), compare_keys))
+			{ std::sort(std::begin(m_values), std::end(m_values), compare_keys); }
+
+			return std::adjacent_find(std::begin(m_values), std::end(m_values),
+				std::not_fn(compare_keys)) == std::end(m_values);
+		}
+
+	private:
+		template<class K>
+		auto lower_bound(K const& key) const
+		{
+			return std::lower_bound(std::begin(m_values), std::end(m_values), key,
+				[](auto const& item, K const& key) {
+					return Compare{}(item.first, key);
+			});
+		}
+
+		template<class K>
+		auto lower_bound(K const& key)
+		{
+			return std::lower_bound(std::begin(m_values), std::end(m_values), key,
+				[](auto const& item, K const& key) {
+					return Compare{}(item.first, key);
+			});
+		}
+
+		storage_type m_values;
+	};
+}
+
+#endif
@@ -0,0 +1,75 @@
+//@	{"target":{"name":"flat_map.test"}}
+
+#include "./flat_map.hpp"
+
+#include <string>
+#include <testfwk/testfwk.hpp>
+
+TESTCASE(jopp_flat_map_insert_and_find)
+{
+	jopp::flat_map<std::string, int> vals;
+	EXPECT_EQ(vals.empty(), true);
+
+	EXPECT_EQ(vals.insert(std::pair{std::string{"b"}, 2}).second, true);
+	EXPECT_EQ(vals.insert(std::pair{std::string{"c"}, 3}).second, true);
+	EXPECT_EQ(vals.insert(std::pair{std::string{"a"}, 1}).second, true);
+	EXPECT_EQ(vals.insert(std::pair{std::string{"b"}, 4}).second, false);
+	EXPECT_EQ(std::size(vals), 3);
+
+	REQUIRE_NE(vals.find(std::string_view{"b"}), std::end(vals));
+	EXPECT_EQ(vals.find(std::string_view{"b"})->second, 2);
+	EXPECT_EQ(vals.find(std::string_view{"d"}), std::end(vals));
+	EXPECT_EQ(vals.contains(std::string_view{"a"}), true);
+	EXPECT_EQ(vals.contains(std::string_view{"0"}), false);
+
+	std::string keys;
+	for(auto const& item : vals)
+	{ keys += item.first; }
+	EXPECT_EQ(keys, "abc");
+}
+
+TESTCASE(jopp_flat_map_insert_or_assign)
+{
+	jopp::flat_map<std::string, int> vals;
+	EXPECT_EQ(vals.insert_or_assign("a", 1).second, true);
+	EXPECT_EQ(vals.insert_or_assign("a", 2).second, false);
+	EXPECT_EQ(std::size(vals), 1);
+	EXPECT_EQ(vals.find(std::string_view{"a"})->second, 2);
+}
+
+TESTCASE(jopp_flat_map_append_and_sort)
+{
+	jopp::flat_map<std::string, int> vals;
+	vals.append(std::pair{std::string{"c"}, 3});
+	vals.append(std::pair{std::string{"a"}, 1});
+	vals.append(std::pair{std::string{"b"}, 2});
+	EXPECT_EQ(vals.sort_unique(), true);
+
+	std::string keys;
+	for(auto const& item : vals)
+	{ keys += item.first; }
+	EXPECT_EQ(keys, "abc");
+	EXPECT_EQ(vals.find(std::string_view{"c"})->second, 3);
+
+	vals.append(std::pair{std::string{"a"}, 4});
+	EXPECT_EQ(vals.sort_unique(), false);
+}
+
+TESTCASE(jopp_flat_map_keys_are_const)
+{
+	jopp::flat_map<std::string, int> vals;
+	vals.insert(std::pair{std::string{"a"}, 1});
+
+	auto const i = vals.find(std::string_view{"a"});
+	static_assert(std::is_same_v<decltype(i->first), std::string const&>);
+	static_assert(std::is_same_v<decltype((*std::begin(vals)).first), std::string const&>);
+	static_assert(std::is_same_v<decltype(std::as_const(vals).begin()->second), int const&>);
+	static_assert(std::is_same_v<jopp::flat_map<std::string, int>::value_type, std::pair<std::string const, int>>);
+
+	i->second = 2;
+	EXPECT_EQ(vals.find(std::string_view{"a"})->second, 2);
+
+	jopp::flat_map<std::string, int>::const_iterator j = i;
+	EXPECT_EQ(j, std::begin(vals));
+	EXPECT_EQ(std::end(vals) - j, 1);
+}
@@ -0,0 +1,387 @@
+#ifndef JOPP_FROM_JSON_HPP
+#define JOPP_FROM_JSON_HPP
+
+#include "./parser.hpp"
+
+#include <array>
+#include <tuple>
+#include <optional>
+#include <vector>
+#include <limits>
+#include <cmath>
+
+namespace jopp::inline JOPP_OBJECT_STORAGE_NAMESPACE
+{
+	// Binds the JSON field name to a member of Owner. To parse into a struct, specialize
+	// object_converter for it with a static constexpr tuple of fields:
+	//
+	//   template<>
+	//   struct jopp::object_converter<request>
+	//   {
+	//       static constexpr std::tuple fields{
+	//           jopp::field{"id", &request::id},
+	//           jopp::field{"items", &request::items}
+	//       };
+	//   };
+	template<class Owner, class T>
+	struct field
+	{
+		std::string_view name;
+		T Owner::* member;
+	};
+
+	template<class Owner, class T>
+	field(char const*, T Owner::*) -> field<Owner, T>;
+
+	template<class T>
+	concept struct_with_fields = requires
+	{
+		std::tuple_size<std::remove_cvref_t<decltype(object_converter<T>::fields)>>::value;
+	};
+
+	// The field names of T, sorted at compile time, so that a key is resolved with a binary search
+	template<struct_with_fields T>
+	struct field_table
+	{
+		static constexpr auto const& fields = object_converter<T>::fields;
+		static constexpr size_t size = std::tuple_size_v<std::remove_cvref_t<decltype(fields)>>;
+
+		struct entry
+		{
+			std::string_view name;
+			size_t index;
+		};
+
+		static constexpr auto entries = []<size_t ... I>(std::index_sequence<I...>) {
+			std::array<entry, size> ret{entry{std::get<I>(fields).name, I}...};
+			std::ranges::sort(ret, std::less<>{}, &entry::name);
+			return ret;
+		}(std::make_index_sequence<size>{});
+
+		static_assert(std::ranges::adjacent_find(entries, std::equal_to<>{}, &entry::name) == std::end(entries),
+			"Field names must be unique");
+
+		static constexpr std::optional<size_t> find(std::string_view name)
+		{
+			auto const i = std::ranges::lower_bound(entries, name, std::less<>{}, &entry::name);
+			if(i == std::end(entries) || i->name != name)
+			{ return std::nullopt; }
+			return i->index;
+		}
+	};
+
+	struct value_sink_ops;
+
+	// Where the next value goes. A sink without ops discards the value.
+	struct value_sink
+	{
+		void* target;
+		value_sink_ops const* ops;
+	};
+
+	struct value_sink_ops
+	{
+		parser_error_code (*on_string)(void* target, std::string_view val);
+		parser_error_code (*on_number)(void* target, number val);
+		parser_error_code (*on_boolean)(void* target, boolean val);
+		parser_error_code (*on_null)(void* target);
+
+		// These return a sink without ops if target is not an object or an array
+		value_sink (*on_begin_object)(void* target);
+		value_sink (*on_begin_array)(void* target);
+
+		// Returns a sink without ops for unknown fields
+		value_sink (*field)(void* target, std::string_view key);
+		value_sink (*element)(void* target);
+	};
+
+	template<class T>
+	struct sink_for;
+
+	template<class T>
+	value_sink make_value_sink(T& target);
+
+	template<class T>
+	struct is_vector : std::false_type {};
+
+	template<class T, class Allocator>
+	struct is_vector<std::vector<T, Allocator>> : std::true_type {};
+
+	template<class T>
+	struct is_optional : std::false_type {};
+
+	template<class T>
+	struct is_optional<std::optional<T>> : std::true_type {};
+
+	template<class T>
+	struct sink_for
+	{
+		static constexpr bool is_string = std::is_assignable_v<T&, std::string_view> && !std::is_arithmetic_v<T>;
+
+		static parser_error_code on_string(void* target, std::string_view val)
+		{
+			if constexpr(is_optional<T>::value)
+			{ return forward_to_value(target, [val](auto sink) { return sink.ops->on_string(sink.target, val); }); }
+			else
+			if constexpr(is_string)
+			{
+				*static_cast<T*>(target) = val;
+				return parser_error_code::more_data_needed;
+			}
+			else
+			{ return parser_error_code::type_mismatch; }
+		}
+
+		static parser_error_code on_number(void* target, number val)
+		{
+			if constexpr(is_optional<T>::value)
+			{ return forward_to_value(target, [val](auto sink) { return sink.ops->on_number(sink.target, val); }); }
+			else
+			if constexpr(std::is_floating_point_v<T>)
+			{
+				*static_cast<T*>(target) = static_cast<T>(val);
+				return parser_error_code::more_data_needed;
+			}
+			else
+			if constexpr(std::is_integral_v<T> && !std::is_same_v<T, bool>)
+			{
+				// Upper bound is 2^N, which is exact, unlike the largest value of T
+				if(std::trunc(val) != val
+					|| val < static_cast<number>(std::numeric_limits<T>::min())
+					|| val >= static_cast<number>(std::numeric_limits<T>::max()/2 + 1)*2.0)
+				{ return parser_error_code::type_mismatch; }
+				*static_cast<T*>(target) = static_cast<T>(val);
+				return parser_error_code::more_data_needed;
+			}
+			else
+			{ return parser_error_code::type_mismatch; }
+		}
+
+		static parser_error_code on_boolean(void* target, boolean val)
+		{
+			if constexpr(is_optional<T>::value)
+			{ return forward_to_value(target, [val](auto sink) { return sink.ops->on_boolean(sink.target, val); }); }
+			else
+			if constexpr(std::is_same_v<T, bool>)
+			{
+				*static_cast<T*>(target) = val;
+				return parser_error_code::more_data_needed;
+			}
+			else
+			{ return parser_error_code::type_mismatch; }
+		}
+
+		static parser_error_code on_null(void* target)
+		{
+			if constexpr(is_optional<T>::value)
+			{
+				static_cast<T*>(target)->reset();
+				return parser_error_code::more_data_needed;
+			}
+			else
+			{ return parser_error_code::type_mismatch; }
+		}
+
+		static value_sink on_begin_object(void* target)
+		{
+			if constexpr(is_optional<T>::value)
+			{
+				auto sink = make_value_sink(static_cast<T*>(target)->emplace());
+				return sink.ops->on_begin_object(sink.target);
+			}
+			else
+			if constexpr(struct_with_fields<T>)
+			{ return make_value_sink(*static_cast<T*>(target)); }
+			else
+			{ return value_sink{nullptr, nullptr}; }
+		}
+
+		static value_sink on_begin_array(void* target)
+		{
+			if constexpr(is_optional<T>::value)
+			{
+				auto sink = make_value_sink(static_cast<T*>(target)->emplace());
+				return sink.ops->on_begin_array(sink.target);
+			}
+			else
+			if constexpr(is_vector<T>::value)
+			{
+				static_cast<T*>(target)->clear();
+				return make_value_sink(*static_cast<T*>(target));
+			}
+			else
+			{ return value_sink{nullptr, nullptr}; }
+		}
+
+		static value_sink field(void* target, std::string_view key)
+		{
+			if constexpr(struct_with_fields<T>)
+			{
+				auto const index = field_table<T>::find(key);
+				if(!index.has_value())
+				{ return value_sink{nullptr, nullptr}; }
+
+				auto& obj = *static_cast<T*>(target);
+				return [&obj, index = *index]<size_t ... I>(std::index_sequence<I...>) {
+					value_sink ret{nullptr, nullptr};
+					(void)((index == I ? (ret = make_value_sink(obj.*std::get<I>(object_converter<T>::fields).member), true) : false)
+						|| ...);
+					return ret;
+				}(std::make_index_sequence<field_table<T>::size>{});
+			}
+			else
+			{ return value_sink{nullptr, nullptr}; }
+		}
+
+		static value_sink element(void* target)
+		{
+			if constexpr(is_vector<T>::value)
+			{ return make_value_sink(static_cast<T*>(target)->emplace_back()); }
+			else
+			{ return value_sink{nullptr, nullptr}; }
+		}
+
+		template<class Callback>
+		static parser_error_code forward_to_value(void* target, Callback&& cb)
+		{ return cb(make_value_sink(static_cast<T*>(target)->emplace())); }
+
+		static constexpr value_sink_ops ops{
+			on_string,
+			on_number,
+			on_boolean,
+			on_null,
+			on_begin_object,
+			on_begin_array,
+			field,
+			element
+		};
+	};
+
+	template<class T>
+	value_sink make_value_sink(T& target)
+	{ return value_sink{&target, &sink_for<T>::ops}; }
+
+	// An event handler that stores values directly into the members they are bound to. Values of
+	// unknown fields are skipped without being stored anywhere.
+	class struct_builder
+	{
+	public:
+		template<class T>
+		explicit struct_builder(T& root):m_root{make_value_sink(root)}, m_skip_depth{0}
+		{}
+
+		parser_error_code on_begin_object()
+		{ return begin_container(&value_sink_ops::on_begin_object, false); }
+
+		parser_error_code on_begin_array()
+		{ return begin_container(&value_sink_ops::on_begin_array, true); }
+
+		parser_error_code on_end_object()
+		{ return end_container(); }
+
+		parser_error_code on_end_array()
+		{ return end_container(); }
+
+		parser_error_code on_key(std::string_view key)
+		{
+			if(m_skip_depth == 0)
+			{
+				auto const& current = m_contexts.back().sink;
+				m_next_field = current.ops->field(current.target, key);
+			}
+			return parser_error_code::more_data_needed;
+		}
+
+		parser_error_code on_string(std::string_view val)
+		{ return store([val](value_sink sink) { return sink.ops->on_string(sink.target, val); }); }
+
+		parser_error_code on_number(number val)
+		{ return store([val](value_sink sink) { return sink.ops->on_number(sink.target, val); }); }
+
+		parser_error_code on_boolean(boolean val)
+		{ return store([val](value_sink sink) { return sink.ops->on_boolean(sink.target, val); }); }
+
+		parser_error_code on_null()
+		{ return store([](value_sink sink) { return sink.ops->on_null(sink.target); }); }
+
+		void reset(value_sink root)
+		{
+			m_root = root;
+			m_contexts.clear();
+			m_skip_depth = 0;
+		}
+
+	private:
+		struct context
+		{
+			value_sink sink;
+			bool is_array;
+		};
+
+		value_sink next_sink()
+		{
+			if(m_contexts.empty())
+			{ return m_root; }
+
+			auto const& current = m_contexts.back();
+			if(current.is_array)
+			{ return current.sink.ops->element(current.sink.target); }
+			return std::exchange(m_next_field, value_sink{nullptr, nullptr});
+		}
+
+		template<class Callback>
+		parser_error_code store(Callback&& cb)
+		{
+			if(m_skip_depth != 0)
+			{ return parser_error_code::more_data_needed; }
+
+			auto const sink = next_sink();
+			return sink.ops != nullptr ? cb(sink) : parser_error_code::more_data_needed;
+		}
+
+		parser_error_code begin_container(value_sink (* value_sink_ops::* begin)(void*), bool is_array)
+		{
+			if(m_skip_depth != 0)
+			{
+				++m_skip_depth;
+				return parser_error_code::more_data_needed;
+			}
+
+			auto const sink = next_sink();
+			if(sink.ops == nullptr)
+			{
+				m_skip_depth = 1;
+				return parser_error_code::more_data_needed;
+			}
+
+			auto const inner = (sink.ops->*begin)(sink.target);
+			if(inner.ops == nullptr)
+			{ return parser_error_code::type_mismatch; }
+			m_contexts.push_back(context{inner, is_array});
+			return parser_error_code::more_data_needed;
+		}
+
+		parser_error_code end_container()
+		{
+			if(m_skip_depth != 0)
+			{ --m_skip_depth; }
+			else
+			{ m_contexts.pop_back(); }
+			return parser_error_code::more_data_needed;
+		}
+
+		value_sink m_root;
+		value_sink m_next_field{nullptr, nullptr};
+		std::vector<context> m_contexts;
+		size_t m_skip_depth;
+	};
+
+	// Parses input directly into obj, without building a container first. Fields that are not
+	// present in input keep their current value. A value of the wrong type for its member results
+	// in type_mismatch.
+	template<class T, parser_policy Policy = default_parser_policy>
+	auto from_json(std::string_view input, T& obj, std::optional<size_t> max_levels = 1024)
+	{ return event_parser<struct_builder, Policy>{max_levels, obj}.parse(input); }
+}
+
+#endif
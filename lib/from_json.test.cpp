@@ -0,0 +1,145 @@
+//@	{"target":{"name":"from_json.test"}}
+
+#include "./from_json.hpp"
+
+#include <testfwk/testfwk.hpp>
+
+#include <string>
+#include <vector>
+#include <optional>
+
+namespace
+{
+	struct item
+	{
+		std::string name;
+		double price{};
+		std::optional<int> quantity;
+	};
+
+	struct request
+	{
+		int64_t id{};
+		bool urgent{};
+		std::string customer;
+		std::vector<item> items;
+		std::vector<std::string> tags;
+		std::optional<item> gift;
+	};
+}
+
+template<>
+struct jopp::object_converter<item>
+{
+	static constexpr std::tuple fields{
+		jopp::field{"name", &item::name},
+		jopp::field{"price", &item::price},
+		jopp::field{"quantity", &item::quantity}
+	};
+};
+
+template<>
+struct jopp::object_converter<request>
+{
+	static constexpr std::tuple fields{
+		jopp::field{"id", &request::id},
+		jopp::field{"urgent", &request::urgent},
+		jopp::field{"customer", &request::customer},
+		jopp::field{"items", &request::items},
+		jopp::field{"tags", &request::tags},
+		jopp::field{"gift", &request::gift}
+	};
+};
+
+TESTCASE(jopp_from_json_field_table)
+{
+	using table = jopp::field_table<request>;
+	static_assert(table::size == 6);
+	static_assert(table::entries[0].name == "customer");
+	static_assert(table::find("items") == 3);
+	static_assert(!table::find("item").has_value());
+	EXPECT_EQ(table::find("urgent").value(), 1);
+}
+
+TESTCASE(jopp_from_json_request)
+{
+	std::string_view input{R"({
+	"id": 1234567890123,
+	"unknown": {"deeply": [{"nested": ["stuff", 1, null]}], "more": true},
+	"customer": "Tab\there",
+	"items": [
+		{"name": "Pen", "price": 1.5, "quantity": 10},
+		{"name": "Paper", "price": 4.25, "quantity": null, "color": "white"}
+	],
+	"tags": ["office", "supplies"],
+	"urgent": true,
+	"gift": {"name": "Candy", "price": 0}
+})"};
+
+	request req;
+	auto const res = jopp::from_json(input, req);
+	EXPECT_EQ(res.ec, jopp::parser_error_code::completed);
+	EXPECT_EQ(req.id, 1234567890123);
+	EXPECT_EQ(req.urgent, true);
+	EXPECT_EQ(req.customer, "Tab\there");
+	REQUIRE_EQ(std::size(req.items), 2);
+	EXPECT_EQ(req.items[0].name, "Pen");
+	EXPECT_EQ(req.items[0].price, 1.5);
+	EXPECT_EQ(req.items[0].quantity.value(), 10);
+	EXPECT_EQ(req.items[1].name, "Paper");
+	EXPECT_EQ(req.items[1].quantity.has_value(), false);
+	REQUIRE_EQ(std::size(req.tags), 2);
+	EXPECT_EQ(req.tags[1], "supplies");
+	REQUIRE_EQ(req.gift.has_value(), true);
+	EXPECT_EQ(req.gift->name, "Candy");
+}
+
+TESTCASE(jopp_from_json_top_level_array)
+{
+	std::vector<item> items;
+	auto const res = jopp::from_json(std::string_view{R"([{"name": "A"}, {"name": "B", "price": 2}])"}, items);
+	EXPECT_EQ(res.ec, jopp::parser_error_code::completed);
+	REQUIRE_EQ(std::size(items), 2);
+	EXPECT_EQ(items[1].name, "B");
+	EXPECT_EQ(items[1].price, 2.0);
+}
+
+TESTCASE(jopp_from_json_type_mismatch)
+{
+	{
+		request req;
+		auto const res = jopp::from_json(std::string_view{R"({"id": "1234"})"}, req);
+		EXPECT_EQ(res.ec, jopp::parser_error_code::type_mismatch);
+		EXPECT_EQ(res.col, 13);
+	}
+
+	{
+		request req;
+		auto const res = jopp::from_json(std::string_view{R"({"id": 1.5})"}, req);
+		EXPECT_EQ(res.ec, jopp::parser_error_code::type_mismatch);
+	}
+
+	{
+		request req;
+		auto const res = jopp::from_json(std::string_view{R"({"items": {"name": "Pen"}})"}, req);
+		EXPECT_EQ(res.ec, jopp::parser_error_code::type_mismatch);
+	}
+
+	{
+		request req;
+		auto const res = jopp::from_json(std::string_view{R"({"urgent": null})"}, req);
+		EXPECT_EQ(res.ec, jopp::parser_error_code::type_mismatch);
+	}
+
+	{
+		item obj;
+		auto const res = jopp::from_json(std::string_view{R"({"quantity": 3000000000})"}, obj);
+		EXPECT_EQ(res.ec, jopp::parser_error_code::type_mismatch);
+	}
+
+	{
+		request req;
+		auto const res = jopp::from_json(std::string_view{R"([1, 2])"}, req);
+		EXPECT_EQ(res.ec, jopp::parser_error_code::type_mismatch);
+	}
+}
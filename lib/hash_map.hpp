@@ -0,0 +1,268 @@
+#ifndef JOPP_HASH_MAP_HPP
+#define JOPP_HASH_MAP_HPP
+
+#include "./const_key_iterator.hpp"
+
+#include <vector>
+#include <memory_resource>
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <string_view>
+#include <random>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+namespace jopp
+{
+	struct hash_seed
+	{
+		uint64_t k0;
+		uint64_t k1;
+	};
+
+	// The seed is drawn once per process, so that colliding keys cannot be precomputed
+	inline hash_seed const& process_hash_seed()
+	{
+		static hash_seed const seed = [](){
+			std::random_device rng;
+			auto const next = [&rng](){ return (uint64_t{rng()} << 32) | uint64_t{rng()}; };
+			auto const k0 = next();
+			return hash_seed{k0, next()};
+		}();
+		return seed;
+	}
+
+	// SipHash-1-3
+	inline uint64_t siphash(std::string_view data, hash_seed const& seed)
+	{
+		uint64_t v0 = 0x736f'6d65'7073'6575 ^ seed.k0;
+		uint64_t v1 = 0x646f'7261'6e64'6f6d ^ seed.k1;
+		uint64_t v2 = 0x6c79'6765'6e65'7261 ^ seed.k0;
+		uint64_t v3 = 0x7465'6462'7974'6573 ^ seed.k1;
+
+		auto const round = [&](){
+			v0 += v1; v1 = std::rotl(v1, 13); v1 ^= v0; v0 = std::rotl(v0, 32);
+			v2 += v3; v3 = std::rotl(v3, 16); v3 ^= v2;
+			v0 += v3; v3 = std::rotl(v3, 21); v3 ^= v0;
+			v2 += v1; v1 = std::rotl(v1, 17); v1 ^= v2; v2 = std::rotl(v2, 32);
+		};
+
+		auto ptr = std::data(data);
+		auto const end = ptr + (std::size(data) & ~size_t{7});
+		while(ptr != end)
+		{
+			uint64_t m{};
+			std::memcpy(&m, ptr, sizeof(m));
+			v3 ^= m;
+			round();
+			v0 ^= m;
+			ptr += sizeof(m);
+		}
+
+		auto b = static_cast<uint64_t>(std::size(data)) << 56;
+		for(size_t k = 0; k != (std::size(data) & 7); ++k)
+		{ b |= uint64_t{static_cast<unsigned char>(ptr[k])} << (8*k); }
+		v3 ^= b;
+		round();
+		v0 ^= b;
+
+		v2 ^= 0xff;
+		round();
+		round();
+		round();
+		return v0 ^ v1 ^ v2 ^ v3;
+	}
+
+	struct seeded_hash
+	{
+		size_t operator()(std::string_view key) const
+		{ return static_cast<size_t>(siphash(key, process_hash_seed())); }
+	};
+
+	// An open-addressing hash table over a vector of items. Iteration follows the order of the
+	// vector, which is insertion order until sort_unique is called. Items added with append are
+	// not hashed until they are needed, so that building a map with append and sort_unique hashes
+	// every key once. Until then, find searches them linearly.
+	template<class Key, class T, class Hash = seeded_hash>
+	class hash_map
+	{
+	public:
+		using key_type = Key;
+		using mapped_type = T;
+		using value_type = std::pair<key_type const, mapped_type>;
+		using allocator_type = std::pmr::polymorphic_allocator<value_type>;
+		using storage_type = std::pmr::vector<std::pair<key_type, mapped_type>>;
+		using iterator = const_key_iterator<typename storage_type::iterator>;
+		using const_iterator = const_key_iterator<typename storage_type::const_iterator>;
+
+		hash_map() = default;
+
+		explicit hash_map(allocator_type alloc):m_values{alloc}, m_slots{alloc}
+		{}
+
+		auto get_allocator() const
+		{ return m_values.get_allocator(); }
+
+		auto begin() const
+		{ return const_iterator{std::begin(m_values)}; }
+
+		auto end() const
+		{ return const_iterator{std::end(m_values)}; }
+
+		auto begin()
+		{ return iterator{std::begin(m_values)}; }
+
+		auto end()
+		{ return iterator{std::end(m_values)}; }
+
+		auto size() const
+		{ return std::size(m_values); }
+
+		bool empty() const
+		{ return m_values.empty(); }
+
+		template<class K>
+		const_iterator find(K const& key) const
+		{ return begin() + static_cast<ptrdiff_t>(find_index(key)); }
+
+		template<class K>
+		iterator find(K const& key)
+		{ return begin() + static_cast<ptrdiff_t>(find_index(key)); }
+
+		template<class K>
+		bool contains(K const& key) const
+		{ return find(key) != end(); }
+
+		std::pair<iterator, bool> insert(std::pair<key_type, mapped_type>&& item)
+		{
+			index_appended();
+			reserve_slot();
+			auto const slot = find_slot(item.first);
+			if(m_slots[slot] != empty_slot)
+			{ return std::pair{begin() + static_cast<ptrdiff_t>(m_slots[slot]), false}; }
+
+			m_slots[slot] = std::size(m_values);
+			m_values.push_back(std::move(item));
+			++m_indexed;
+			return std::pair{end() - 1, true};
+		}
+
+		template<class M>
+		std::pair<iterator, bool> insert_or_assign(key_type&& key, M&& val)
+		{
+			index_appended();
+			reserve_slot();
+			auto const slot = find_slot(key);
+			if(m_slots[slot] != empty_slot)
+			{
+				auto const i = begin() + static_cast<ptrdiff_t>(m_slots[slot]);
+				i->second = std::forward<M>(val);
+				return std::pair{i, false};
+			}
+
+			m_slots[slot] = std::size(m_values);
+			m_values.emplace_back(std::move(key), std::forward<M>(val));
+			++m_indexed;
+			return std::pair{end() - 1, true};
+		}
+
+		// Does not look for key first. A duplicated key is reported by sort_unique.
+		void append(std::pair<key_type, mapped_type>&& item)
+		{ m_values.push_back(std::move(item)); }
+
+		// Sorts the items by key and rebuilds the table. Returns false if any key occurs more than
+		// once.
+		bool sort_unique()
+		{
+			auto const compare_keys = [](auto const& a, auto const& b) {
+				return std::less<>{}(a.first, b.first);
+			};
+
+			if(!std::is_sorted(std::begin(m_values), std::end(m_values), compare_keys))
+			{ std::sort(std::begin(m_values), std::end(m_values), compare_keys); }
+
+			rehash(std::bit_ceil(2*std::size(m_values) + 1));
+			return std::adjacent_find(std::begin(m_values), std::end(m_values),
+				std::not_fn(compare_keys)) == std::end(m_values);
+		}
+
+	private:
+		static constexpr auto empty_slot = static_cast<size_t>(-1);
+
+		// Returns the size of the map if key is not found
+		template<class K>
+		size_t find_index(K const& key) const
+		{
+			if(!m_slots.empty())
+			{
+				auto const index = m_slots[find_slot(key)];
+				if(index != empty_slot)
+				{ return index; }
+			}
+
+			auto const i = std::find_if(std::begin(m_values) + static_cast<ptrdiff_t>(m_indexed),
+				std::end(m_values),
+				[&key](auto const& item) { return item.first == key; });
+			return static_cast<size_t>(i - std::begin(m_values));
+		}
+
+		template<class K>
+		size_t find_slot(K const& key) const
+		{
+			auto const mask = std::size(m_slots) - 1;
+			auto slot = Hash{}(key) & mask;
+			while(m_slots[slot] != empty_slot && !(m_values[m_slots[slot]].first == key))
+			{ slot = (slot + 1) & mask; }
+			return slot;
+		}
+
+		void reserve_slot()
+		{
+			// Keep the load factor below 1/2, so that probe sequences stay short
+			if(2*(std::size(m_values) + 1) > std::size(m_slots))
+			{ rehash(std::max(std::size(m_slots)*2, size_t{8})); }
+		}
+
+		// Items that have been appended since the last rehash are added to the table. Duplicated
+		// keys are added as well. The first one is then found first, and sort_unique reports them.
+		void index_appended()
+		{
+			if(m_indexed == std::size(m_values))
+			{ return; }
+
+			if(2*(std::size(m_values) + 1) > std::size(m_slots))
+			{
+				rehash(std::bit_ceil(2*std::size(m_values) + 2));
+				return;
+			}
+
+			for(; m_indexed != std::size(m_values); ++m_indexed)
+			{ add_to_table(m_indexed); }
+		}
+
+		void rehash(size_t slot_count)
+		{
+			m_slots.assign(slot_count, empty_slot);
+			for(size_t k = 0; k != std::size(m_values); ++k)
+			{ add_to_table(k); }
+			m_indexed = std::size(m_values);
+		}
+
+		void add_to_table(size_t index)
+		{
+			auto const mask = std::size(m_slots) - 1;
+			auto slot = Hash{}(m_values[index].first) & mask;
+			while(m_slots[slot] != empty_slot)
+			{ slot = (slot + 1) & mask; }
+			m_slots[slot] = index;
+		}
+
+		storage_type m_values;
+		std::pmr::vector<size_t> m_slots;
+		size_t m_indexed{0};
+	};
+}
+
+#endif
@@ -0,0 +1,105 @@
+//@	{"target":{"name":"hash_map.test"}}
+
+#include "./hash_map.hpp"
+
+#include <string>
+#include <testfwk/testfwk.hpp>
+
+TESTCASE(jopp_siphash_depends_on_seed)
+{
+	std::string msg;
+	for(char k = 0; k != 15; ++k)
+	{ msg += k; }
+	jopp::hash_seed const seed{0x0706'0504'0302'0100, 0x0f0e'0d0c'0b0a'0908};
+	EXPECT_EQ(jopp::siphash(msg, seed), jopp::siphash(msg, seed));
+	EXPECT_NE(jopp::siphash(msg, seed), jopp::siphash(msg, jopp::hash_seed{1, 2}));
+	EXPECT_NE(jopp::siphash(msg, seed), jopp::siphash(std::string_view{msg}.substr(1), seed));
+}
+
+TESTCASE(jopp_hash_map_insert_and_find)
+{
+	jopp::hash_map<std::string, int> vals;
+	EXPECT_EQ(vals.empty(), true);
+	EXPECT_EQ(vals.find(std::string_view{"a"}), std::end(vals));
+
+	for(int k = 0; k != 1000; ++k)
+	{ EXPECT_EQ(vals.insert(std::pair{std::to_string(k), k}).second, true); }
+	EXPECT_EQ(vals.insert(std::pair{std::string{"500"}, 0}).second, false);
+	EXPECT_EQ(std::size(vals), 1000);
+
+	for(int k = 0; k != 1000; ++k)
+	{
+		auto const i = vals.find(std::string_view{std::to_string(k)});
+		REQUIRE_NE(i, std::end(vals));
+		EXPECT_EQ(i->second, k);
+	}
+	EXPECT_EQ(vals.contains(std::string_view{"1000"}), false);
+
+	EXPECT_EQ(vals.insert_or_assign("500", -1).second, false);
+	EXPECT_EQ(vals.find(std::string_view{"500"})->second, -1);
+	EXPECT_EQ(vals.insert_or_assign("1000", 1000).second, true);
+	EXPECT_EQ(std::size(vals), 1001);
+}
+
+TESTCASE(jopp_hash_map_append_and_sort)
+{
+	jopp::hash_map<std::string, int> vals;
+	vals.append(std::pair{std::string{"c"}, 3});
+	vals.append(std::pair{std::string{"a"}, 1});
+	vals.append(std::pair{std::string{"b"}, 2});
+	EXPECT_EQ(vals.sort_unique(), true);
+
+	std::string keys;
+	for(auto const& item : vals)
+	{ keys += item.first; }
+	EXPECT_EQ(keys, "abc");
+	REQUIRE_NE(vals.find(std::string_view{"c"}), std::end(vals));
+	EXPECT_EQ(vals.find(std::string_view{"c"})->second, 3);
+
+	vals.append(std::pair{std::string{"a"}, 4});
+	EXPECT_EQ(vals.sort_unique(), false);
+}
+
+TESTCASE(jopp_hash_map_find_and_insert_after_append)
+{
+	jopp::hash_map<std::string, int> vals;
+	vals.insert(std::pair{std::string{"a"}, 1});
+	vals.append(std::pair{std::string{"b"}, 2});
+	vals.append(std::pair{std::string{"c"}, 3});
+
+	REQUIRE_NE(vals.find(std::string_view{"b"}), std::end(vals));
+	EXPECT_EQ(vals.find(std::string_view{"b"})->second, 2);
+	EXPECT_EQ(vals.contains(std::string_view{"d"}), false);
+
+	EXPECT_EQ(vals.insert(std::pair{std::string{"c"}, 4}).second, false);
+	EXPECT_EQ(vals.insert_or_assign("b", 5).second, false);
+	EXPECT_EQ(std::size(vals), 3);
+	EXPECT_EQ(vals.find(std::string_view{"b"})->second, 5);
+
+	for(int k = 0; k != 100; ++k)
+	{ vals.append(std::pair{std::to_string(k), k}); }
+	EXPECT_EQ(vals.insert(std::pair{std::string{"50"}, 0}).second, false);
+	EXPECT_EQ(vals.insert(std::pair{std::string{"100"}, 100}).second, true);
+	EXPECT_EQ(std::size(vals), 104);
+	EXPECT_EQ(vals.sort_unique(), true);
+	EXPECT_EQ(vals.find(std::string_view{"50"})->second, 50);
+}
+
+TESTCASE(jopp_hash_map_find_after_failed_sort)
+{
+	jopp::hash_map<std::string, int> vals;
+	vals.append(std::pair{std::string{"c"}, 3});
+	vals.append(std::pair{std::string{"a"}, 1});
+	vals.append(std::pair{std::string{"c"}, 4});
+	EXPECT_EQ(vals.sort_unique(), false);
+	REQUIRE_NE(vals.find(std::string_view{"a"}), std::end(vals));
+	EXPECT_EQ(vals.find(std::string_view{"a"})->second, 1);
+	EXPECT_EQ(vals.insert(std::pair{std::string{"c"}, 5}).second, false);
+}
+
+TESTCASE(jopp_hash_map_keys_are_const)
+{
+	static_assert(std::is_same_v<jopp::hash_map<std::string, int>::value_type, std::pair<std::string const, int>>);
+	static_assert(std::is_same_v<decltype(std::declval<jopp::hash_map<std::string, int>&>().begin()->first),
+		std::string const&>);
+}
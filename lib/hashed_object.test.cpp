@@ -0,0 +1,151 @@
+//@	{"target":{"name":"hashed_object.test"}}
+
+#define JOPP_HASHED_OBJECTS
+#include "./parser.hpp"
+#include "./fast_parser.hpp"
+#include "./serializer.hpp"
+
+#include <testfwk/testfwk.hpp>
+
+static_assert(std::is_same_v<jopp::object, jopp::hashed_objects::object>);
+static_assert(std::is_same_v<jopp::parser, jopp::hashed_objects::parser>);
+
+TESTCASE(jopp_hashed_object_parse)
+{
+	std::string_view data{R"({"c": 3, "a": {"z": true, "y": null}, "b": [1, {"q": 2, "p": 1}]})"};
+
+	jopp::container val;
+	jopp::parser parser{val};
+	auto const res = parser.parse(data);
+	REQUIRE_EQ(res.ec, jopp::parser_error_code::completed);
+
+	auto const& root = val.get<jopp::object>();
+	std::string keys;
+	for(auto const& item : root)
+	{ keys += item.first; }
+	EXPECT_EQ(keys, "abc");
+	EXPECT_EQ(root.get_field_as<jopp::number>("c"), 3.0);
+	EXPECT_EQ(root.get_field_as<jopp::object>("a").begin()->first, "y");
+
+	auto const& array = root.get_field_as<jopp::array>("b");
+	REQUIRE_EQ(std::size(array), 2);
+	EXPECT_EQ(array[1].get<jopp::object>().get_field_as<jopp::number>("p"), 1.0);
+
+	jopp::container other;
+	jopp::fast_parser fast_parser{other};
+	EXPECT_EQ(fast_parser.parse(data).ec, jopp::parser_error_code::completed);
+	keys.clear();
+	for(auto const& item : other.get<jopp::object>())
+	{ keys += item.first; }
+	EXPECT_EQ(keys, "abc");
+}
+
+TESTCASE(jopp_hashed_object_duplicate_key)
+{
+	// Duplicate keys are detected when the object is closed
+	std::string_view data{R"({"the key": "123", "other key": 1, "the key": "124"})"};
+
+	jopp::container val;
+	jopp::parser parser{val};
+	auto const res = parser.parse(data);
+	EXPECT_EQ(res.ec, jopp::parser_error_code::key_already_exists);
+	EXPECT_EQ(res.col, std::size(data));
+
+	jopp::container other;
+	jopp::fast_parser fast_parser{other};
+	auto const fast_res = fast_parser.parse(data);
+	EXPECT_EQ(fast_res.ec, jopp::parser_error_code::key_already_exists);
+	EXPECT_EQ(fast_res.col, std::size(data));
+}
+
+TESTCASE(jopp_hashed_object_insert)
+{
+	jopp::object obj;
+	EXPECT_EQ(obj.insert("b", 2.0).second, true);
+	EXPECT_EQ(obj.insert("a", 1.0).second, true);
+	EXPECT_EQ(obj.insert("b", 3.0).second, false);
+	EXPECT_EQ(obj.begin()->first, "b");
+	EXPECT_EQ(obj.get_field_as<jopp::number>("b"), 2.0);
+
+	EXPECT_EQ(obj.sort_fields(), true);
+	EXPECT_EQ(obj.begin()->first, "a");
+	EXPECT_EQ(obj.get_field_as<jopp::number>("b"), 2.0);
+}
+
+TESTCASE(jopp_hashed_object_many_keys)
+{
+	std::string data{"{"};
+	for(size_t k = 0; k != 4096; ++k)
+	{
+		if(k != 0)
+		{ data += ", "; }
+		data.append("\"id_").append(std::to_string(k)).append("\": ").append(std::to_string(k));
+	}
+	data += "}";
+
+	jopp::container val;
+	jopp::fast_parser parser{val};
+	REQUIRE_EQ(parser.parse(std::string_view{data}).ec, jopp::parser_error_code::completed);
+
+	auto const& root = val.get<jopp::object>();
+	EXPECT_EQ(std::size(root), 4096);
+	for(size_t k = 0; k != 4096; ++k)
+	{
+		auto const key = std::string{"id_"}.append(std::to_string(k));
+		EXPECT_EQ(root.get_field_as<jopp::number>(key), static_cast<double>(k));
+	}
+	EXPECT_EQ(root.try_get_field_as<jopp::number>("id_4096"), nullptr);
+}
+
+namespace
+{
+	constexpr std::string_view unordered_data{R"({"c": 3, "a": {"z": true, "y": null}, "b": [1, {"q": 2, "p": 1}]})"};
+
+	std::string serialize_in_blocks(jopp::container const& root, bool pretty_print, size_t block_size)
+	{
+		jopp::serializer serializer{root, pretty_print};
+		std::string output;
+		std::array<char, 7> buffer{};
+		while(true)
+		{
+			auto const res = serializer.serialize(std::span{std::data(buffer), block_size});
+			output.append(std::data(buffer), res.ptr);
+			if(res.ec == jopp::serializer_error_code::completed)
+			{ return output; }
+			REQUIRE_EQ(res.ec, jopp::serializer_error_code::buffer_is_full);
+		}
+	}
+}
+
+TESTCASE(jopp_hashed_object_serialize)
+{
+	jopp::container val;
+	jopp::fast_parser parser{val};
+	REQUIRE_EQ(parser.parse(unordered_data).ec, jopp::parser_error_code::completed);
+
+	std::string_view const compact{"{\"a\":{\"y\":null,\"z\":true},\"b\":[1,{\"p\":1,\"q\":2}],\"c\":3}\n"};
+	std::string_view const pretty{"{\n\t\"a\": {\n\t\t\"y\": null,\n\t\t\"z\": true\n\t},\n\t\"b\": [\n\t\t1,\n\t\t{\n"
+		"\t\t\t\"p\": 1,\n\t\t\t\"q\": 2\n\t\t}\n\t],\n\t\"c\": 3\n}\n"};
+	EXPECT_EQ(jopp::to_string(val), compact);
+	EXPECT_EQ(jopp::to_string(val, true), pretty);
+	EXPECT_EQ(jopp::serialized_size(val).value(), std::size(compact));
+	EXPECT_EQ(jopp::serialized_size(val, true).value(), std::size(pretty));
+	for(size_t block_size : {1, 3, 7})
+	{
+		EXPECT_EQ(serialize_in_blocks(val, false, block_size), compact);
+		EXPECT_EQ(serialize_in_blocks(val, true, block_size), pretty);
+	}
+}
+
+TESTCASE(jopp_hashed_object_serialize_insertion_order)
+{
+	jopp::object obj;
+	obj.insert("b", 2.0);
+	obj.insert("a", 1.0);
+	obj.insert("c", 3.0);
+	jopp::container val{std::move(obj)};
+	EXPECT_EQ(jopp::to_string(val), "{\"b\":2,\"a\":1,\"c\":3}\n");
+
+	val.get<jopp::object>().sort_fields();
+	EXPECT_EQ(jopp::to_string(val), "{\"a\":1,\"b\":2,\"c\":3}\n");
+}
@@ -0,0 +1,215 @@
+#ifndef JOPP_MAPPED_FILE_HPP
+#define JOPP_MAPPED_FILE_HPP
+
+#include "./document.hpp"
+#include "./parser.hpp"
+#include "./fast_parser.hpp"
+
+#include <filesystem>
+#include <system_error>
+#include <memory>
+#include <utility>
+#include <span>
+#include <string>
+#include <array>
+#include <vector>
+#include <cerrno>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace jopp::inline JOPP_OBJECT_STORAGE_NAMESPACE
+{
+	// A read-only mapping of a file, or of a window into it
+	class mapped_file
+	{
+	public:
+		// Maps the whole file
+		explicit mapped_file(int fd):mapped_file{fd, 0, file_size(fd)}
+		{}
+
+		// Maps size bytes starting at offset, which must be a multiple of the page size
+		explicit mapped_file(int fd, size_t offset, size_t size):m_data{nullptr}, m_size{size}
+		{
+			if(size == 0)
+			{ return; }
+
+			auto const ptr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, static_cast<off_t>(offset));
+			if(ptr == MAP_FAILED)
+			{ throw std::system_error{errno, std::generic_category(), "Failed to map file"}; }
+
+			// Hints only, so failures are ignored
+			::madvise(ptr, size, MADV_SEQUENTIAL);
+			::madvise(ptr, size, MADV_WILLNEED);
+			m_data = static_cast<char const*>(ptr);
+		}
+
+		mapped_file(mapped_file&& other) noexcept:
+			m_data{std::exchange(other.m_data, nullptr)},
+			m_size{std::exchange(other.m_size, 0)}
+		{}
+
+		mapped_file& operator=(mapped_file&& other) noexcept
+		{
+			std::swap(m_data, other.m_data);
+			std::swap(m_size, other.m_size);
+			return *this;
+		}
+
+		~mapped_file()
+		{
+			if(m_data != nullptr)
+			{ ::munmap(const_cast<char*>(m_data), m_size); }
+		}
+
+		std::string_view view() const
+		{ return std::string_view{m_data, m_size}; }
+
+		static struct stat file_status(int fd)
+		{
+			struct stat info{};
+			if(::fstat(fd, &info) == -1)
+			{ throw std::system_error{errno, std::generic_category(), "Failed to get file size"}; }
+			return info;
+		}
+
+		static size_t file_size(int fd)
+		{ return static_cast<size_t>(file_status(fd).st_size); }
+
+		// Pipes, FIFOs, and terminals report size 0, and cannot be mapped
+		static bool can_map(int fd)
+		{ return S_ISREG(file_status(fd).st_mode); }
+
+		static size_t page_size()
+		{ return static_cast<size_t>(::sysconf(_SC_PAGESIZE)); }
+
+	private:
+		char const* m_data;
+		size_t m_size;
+	};
+
+	class file_descriptor
+	{
+	public:
+		explicit file_descriptor(std::filesystem::path const& path):m_fd{::open(path.c_str(), O_RDONLY)}
+		{
+			if(m_fd == -1)
+			{ throw std::system_error{errno, std::generic_category(), "Failed to open " + path.string()}; }
+		}
+
+		file_descriptor(file_descriptor const&) = delete;
+		file_descriptor& operator=(file_descriptor const&) = delete;
+
+		~file_descriptor()
+		{ ::close(m_fd); }
+
+		int get() const
+		{ return m_fd; }
+
+	private:
+		int m_fd;
+	};
+
+	// Returns 0 at end of file
+	inline size_t read_some(int fd, std::span<char> buffer)
+	{
+		while(true)
+		{
+			auto const n = ::read(fd, std::data(buffer), std::size(buffer));
+			if(n != -1)
+			{ return static_cast<size_t>(n); }
+
+			if(errno != EINTR)
+			{ throw std::system_error{errno, std::generic_category(), "Failed to read file"}; }
+		}
+	}
+
+	inline std::string read_all(int fd)
+	{
+		std::string ret;
+		std::array<char, 65536> buffer;
+		while(auto const n = read_some(fd, buffer))
+		{ ret.append(std::data(buffer), n); }
+		return ret;
+	}
+
+	struct file_parse_options
+	{
+		std::optional<size_t> max_levels = 1024;
+		std::pmr::memory_resource* resource = std::pmr::get_default_resource();
+
+		// Files larger than this are mapped and parsed one window at a time, with a parser that
+		// does not need the whole input. This is slower than the fast_parser used for smaller files.
+		size_t window_size = size_t{1} << 30;
+
+		// Size of the reads, for input that cannot be mapped
+		size_t read_size = 65536;
+	};
+
+	// Parses a file without copying it into a staging buffer. Since the mapping is gone when this
+	// function returns, ptr in the result is the offset in the file where parsing stopped. Input
+	// that cannot be mapped, such as a pipe, is read in blocks of read_size instead.
+	inline parse_result<size_t> parse_file(int fd, container& root,
+		file_parse_options const& options = file_parse_options{})
+	{
+		if(!mapped_file::can_map(fd))
+		{
+			parser parser{root, options.max_levels, options.resource};
+			std::vector<char> buffer(std::max(options.read_size, size_t{1}));
+			size_t offset = 0;
+			while(true)
+			{
+				auto const view = std::span{std::data(buffer), read_some(fd, buffer)};
+				auto const res = parser.parse(view);
+				if(res.ec != parser_error_code::more_data_needed || std::empty(view))
+				{ return parse_result{offset + static_cast<size_t>(res.ptr - std::begin(view)), res.ec, res.line, res.col}; }
+				offset += std::size(view);
+			}
+		}
+
+		auto const size = mapped_file::file_size(fd);
+		if(size <= options.window_size)
+		{
+			mapped_file const input{fd, 0, size};
+			auto const res = fast_parser{root, options.max_levels, options.resource}.parse(input.view());
+			return parse_result{static_cast<size_t>(res.ptr - std::data(input.view())), res.ec, res.line, res.col};
+		}
+
+		auto const window_size = std::max((options.window_size/mapped_file::page_size())*mapped_file::page_size(),
+			mapped_file::page_size());
+		parser parser{root, options.max_levels, options.resource};
+		size_t offset = 0;
+		while(true)
+		{
+			mapped_file const input{fd, offset, std::min(window_size, size - offset)};
+			auto const view = std::span{std::data(input.view()), std::size(input.view())};
+			auto const res = parser.parse(view);
+			if(res.ec != parser_error_code::more_data_needed || offset + std::size(view) == size)
+			{ return parse_result{offset + static_cast<size_t>(res.ptr - std::begin(view)), res.ec, res.line, res.col}; }
+			offset += std::size(view);
+		}
+	}
+
+	inline parse_result<size_t> parse_file(std::filesystem::path const& path, container& root,
+		file_parse_options const& options = file_parse_options{})
+	{ return parse_file(file_descriptor{path}.get(), root, options); }
+
+	// Maps the file into a document. String values without escape sequences then refer directly
+	// to the mapping, so the input is never copied. Input that cannot be mapped is read into the
+	// document.
+	inline document map_document(std::filesystem::path const& path,
+		std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+	{
+		file_descriptor const fd{path};
+		if(!mapped_file::can_map(fd.get()))
+		{ return document{read_all(fd.get()), resource}; }
+
+		auto input = std::make_shared<mapped_file>(fd.get());
+		auto const view = input->view();
+		return document{std::move(input), view, resource};
+	}
+}
+
+#endif
@@ -0,0 +1,183 @@
+//@	{"target":{"name":"mapped_file.test"}}
+
+#include "./mapped_file.hpp"
+
+#include <testfwk/testfwk.hpp>
+
+#include <fstream>
+#include <string>
+#include <thread>
+
+namespace
+{
+	class temp_file
+	{
+	public:
+		explicit temp_file(std::string_view content):
+			m_path{std::filesystem::temp_directory_path()/("jopp_mapped_file_test_" + std::to_string(::getpid()))}
+		{
+			std::ofstream output{m_path, std::ios::binary};
+			output.write(std::data(content), static_cast<std::streamsize>(std::size(content)));
+		}
+
+		~temp_file()
+		{ std::filesystem::remove(m_path); }
+
+		auto const& path() const
+		{ return m_path; }
+
+	private:
+		std::filesystem::path m_path;
+	};
+
+	// A pipe holding content, with the write end closed
+	class filled_pipe
+	{
+	public:
+		explicit filled_pipe(std::string_view content)
+		{
+			REQUIRE_EQ(::pipe(m_fds), 0);
+			REQUIRE_EQ(::write(m_fds[1], std::data(content), std::size(content)),
+				static_cast<ssize_t>(std::size(content)));
+			::close(m_fds[1]);
+		}
+
+		~filled_pipe()
+		{ ::close(m_fds[0]); }
+
+		int get() const
+		{ return m_fds[0]; }
+
+	private:
+		int m_fds[2];
+	};
+
+	std::string make_large_array(size_t count)
+	{
+		std::string ret{"["};
+		for(size_t k = 0; k != count; ++k)
+		{
+			if(k != 0)
+			{ ret.append(",\n"); }
+			ret.append("{\"seq\": ").append(std::to_string(k)).append(", \"name\": \"Item\"}");
+		}
+		ret.append("]\n");
+		return ret;
+	}
+}
+
+TESTCASE(jopp_parse_file)
+{
+	temp_file const file{R"({"foo": "bar", "items": [1, 2, 3]} trailing)"};
+	jopp::container root;
+	auto const res = jopp::parse_file(file.path(), root);
+	EXPECT_EQ(res.ec, jopp::parser_error_code::completed);
+	EXPECT_EQ(res.ptr, 34);
+	auto const& obj = root.get<jopp::object>();
+	EXPECT_EQ(obj.get_field_as<jopp::string>("foo"), "bar");
+	EXPECT_EQ(std::size(obj.get_field_as<jopp::array>("items")), 3);
+}
+
+TESTCASE(jopp_parse_file_windowed)
+{
+	auto const content = make_large_array(4096);
+	temp_file const file{content};
+	for(auto window_size : {size_t{1}, jopp::mapped_file::page_size(), 3*jopp::mapped_file::page_size()})
+	{
+		jopp::file_parse_options options;
+		options.window_size = window_size;
+		jopp::container root;
+		auto const res = jopp::parse_file(file.path(), root, options);
+		EXPECT_EQ(res.ec, jopp::parser_error_code::completed);
+		EXPECT_EQ(res.ptr, std::size(content) - 1);
+		EXPECT_EQ(res.line, 4096);
+
+		auto const& items = root.get<jopp::array>();
+		REQUIRE_EQ(std::size(items), 4096);
+		EXPECT_EQ(items[4095].get<jopp::object>().get_field_as<jopp::number>("seq"), 4095.0);
+	}
+}
+
+TESTCASE(jopp_parse_file_errors)
+{
+	{
+		temp_file const file{"{\"foo\": [1, 2"};
+		jopp::container root;
+		auto const res = jopp::parse_file(file.path(), root);
+		EXPECT_EQ(res.ec, jopp::parser_error_code::more_data_needed);
+	}
+
+	{
+		temp_file const file{""};
+		jopp::container root;
+		auto const res = jopp::parse_file(file.path(), root);
+		EXPECT_EQ(res.ec, jopp::parser_error_code::more_data_needed);
+		EXPECT_EQ(res.ptr, 0);
+	}
+
+	jopp::container root;
+	try
+	{
+		(void)jopp::parse_file("/this/file/does/not/exist.json", root);
+		EXPECT_EQ(true, false);
+	}
+	catch(std::system_error const& err)
+	{ EXPECT_EQ(err.code().value(), ENOENT); }
+}
+
+TESTCASE(jopp_map_document)
+{
+	temp_file const file{R"({"no escapes": "Refers to the mapping", "escapes": "Tab\there"})"};
+	auto doc = jopp::map_document(file.path());
+	auto const res = doc.parse();
+	REQUIRE_EQ(res.ec, jopp::parser_error_code::completed);
+
+	auto const& root = doc.root().get<jopp::object>();
+	auto const& ref = root.get_field_as<jopp::string_ref>("no escapes");
+	EXPECT_EQ(ref.view(), "Refers to the mapping");
+	EXPECT_EQ(std::data(ref.view()) > std::data(doc.input()), true);
+	EXPECT_EQ(std::data(ref.view()) < std::data(doc.input()) + std::size(doc.input()), true);
+	EXPECT_EQ(root.get_field_as<jopp::string>("escapes"), "Tab\there");
+}
+
+TESTCASE(jopp_parse_file_pipe)
+{
+	auto const content = make_large_array(64).append("trailing");
+	for(size_t read_size : {size_t{7}, size_t{65536}})
+	{
+		filled_pipe const input{content};
+		jopp::container root;
+		jopp::file_parse_options options;
+		options.read_size = read_size;
+		auto const res = jopp::parse_file(input.get(), root, options);
+		EXPECT_EQ(res.ec, jopp::parser_error_code::completed);
+		EXPECT_EQ(res.ptr, content.find("trailing") - 1);
+		EXPECT_EQ(std::size(root.get<jopp::array>()), 64);
+	}
+
+	{
+		filled_pipe const input{"[1, 2"};
+		jopp::container root;
+		auto const res = jopp::parse_file(input.get(), root);
+		EXPECT_EQ(res.ec, jopp::parser_error_code::more_data_needed);
+		EXPECT_EQ(res.ptr, 5);
+	}
+}
+
+TESTCASE(jopp_map_document_fifo)
+{
+	auto const path = std::filesystem::temp_directory_path()/("jopp_mapped_file_test_fifo_" + std::to_string(::getpid()));
+	REQUIRE_EQ(::mkfifo(path.c_str(), 0600), 0);
+	std::string_view const content{R"({"key": "value"})"};
+	std::jthread writer{[&path, content]() {
+		std::ofstream output{path, std::ios::binary};
+		output.write(std::data(content), static_cast<std::streamsize>(std::size(content)));
+	}};
+
+	auto doc = jopp::map_document(path);
+	writer.join();
+	std::filesystem::remove(path);
+	EXPECT_EQ(doc.input(), content);
+	REQUIRE_EQ(doc.parse().ec, jopp::parser_error_code::completed);
+	EXPECT_EQ(doc.root().get<jopp::object>().get_field_as<std::string_view>("key"), "value");
+}
@@ -0,0 +1,224 @@
+#ifndef JOPP_NDJSON_HPP
+#define JOPP_NDJSON_HPP
+
+#include "./fast_parser.hpp"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <algorithm>
+#include <cstring>
+
+namespace jopp::inline JOPP_OBJECT_STORAGE_NAMESPACE
+{
+	enum class delivery_order
+	{
+		input,
+		completion
+	};
+
+	struct ndjson_options
+	{
+		size_t thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+		size_t chunk_size = 4*1024*1024;
+		delivery_order order = delivery_order::input;
+		std::optional<size_t> max_levels = 1024;
+	};
+
+	// A document together with the arena it has been allocated from. All documents from the same
+	// chunk share one arena, which is released when the last of them is destroyed.
+	struct ndjson_document
+	{
+		std::shared_ptr<std::pmr::monotonic_buffer_resource> arena;
+		container root;
+	};
+
+	struct ndjson_chunk_result
+	{
+		std::vector<ndjson_document> documents;
+		char const* error_ptr;
+		char const* error_pos;
+		parser_error_code ec;
+		size_t line_count;
+	};
+
+	// Splits input after a newline, at roughly every chunk_size byte
+	inline std::vector<std::string_view> split_ndjson(std::string_view input, size_t chunk_size)
+	{
+		std::vector<std::string_view> ret;
+		while(!input.empty())
+		{
+			auto const split_at = std::min(std::max(chunk_size, size_t{1}) - 1, std::size(input) - 1);
+			auto const newline = input.find('\n', split_at);
+			auto const chunk_end = newline == std::string_view::npos ? std::size(input) : newline + 1;
+			ret.push_back(input.substr(0, chunk_end));
+			input.remove_prefix(chunk_end);
+		}
+		return ret;
+	}
+
+	// Parses one document per line. Blank lines are skipped. Anything but whitespace after the
+	// document on the same line is an error.
+	inline ndjson_chunk_result parse_ndjson_chunk(std::string_view chunk, std::optional<size_t> max_levels)
+	{
+		auto arena = std::make_shared<std::pmr::monotonic_buffer_resource>();
+		ndjson_chunk_result ret{{}, nullptr, nullptr, parser_error_code::completed, 0};
+		container root;
+		fast_parser parser{root, max_levels, arena.get()};
+		auto ptr = std::data(chunk);
+		auto const end = ptr + std::size(chunk);
+		while(ptr != end)
+		{
+			auto line_end = static_cast<char const*>(std::memchr(ptr, '\n', static_cast<size_t>(end - ptr)));
+			line_end = line_end == nullptr ? end : line_end;
+			if(!std::all_of(ptr, line_end, is_whitespace))
+			{
+				auto const res = parser.parse(std::string_view{ptr, line_end});
+				if(res.ec == parser_error_code::more_data_needed)
+				{
+					// Point at the beginning of the line, so the caller can resume from there
+					ret.error_ptr = ptr;
+					ret.error_pos = line_end;
+					ret.ec = res.ec;
+					return ret;
+				}
+
+				if(res.ec != parser_error_code::completed)
+				{
+					ret.error_ptr = res.ptr;
+					ret.error_pos = res.ptr - 1;
+					ret.ec = res.ec;
+					return ret;
+				}
+
+				if(auto const i = std::find_if_not(res.ptr, line_end, is_whitespace); i != line_end)
+				{
+					ret.error_ptr = i + 1;
+					ret.error_pos = i;
+					ret.ec = parser_error_code::illegal_delimiter;
+					return ret;
+				}
+
+				ret.documents.push_back(ndjson_document{arena, std::move(root)});
+			}
+
+			ret.line_count += line_end != end ? 1 : 0;
+			ptr = line_end == end ? end : line_end + 1;
+		}
+		return ret;
+	}
+
+	// Parses newline-delimited JSON on thread_count threads, and calls on_document with an
+	// ndjson_document&& for every line that holds a document. on_document is always called from
+	// the calling thread. With delivery_order::input, documents are delivered in input order, and
+	// none after the first error. With delivery_order::completion, documents are delivered as soon
+	// as their chunk has been parsed. If a line ends within a document, more_data_needed is
+	// returned, with ptr pointing at the beginning of that line.
+	template<class Callback>
+	parse_result<char const*> parse_ndjson(std::string_view input,
+		Callback&& on_document,
+		ndjson_options const& options = ndjson_options{})
+	{
+		auto const chunks = split_ndjson(input, options.chunk_size);
+		std::vector<std::optional<ndjson_chunk_result>> results(std::size(chunks));
+		std::deque<size_t> ready;
+		std::mutex mtx;
+		std::condition_variable cv;
+		size_t next_chunk = 0;
+		size_t delivered = 0;
+		auto stop = false;
+
+		// Limits the number of chunks held in memory, while waiting for an earlier chunk
+		auto const window = 2*std::max(options.thread_count, size_t{1});
+		auto const worker = [&]() {
+			while(true)
+			{
+				size_t index{};
+				{
+					std::unique_lock lock{mtx};
+					cv.wait(lock, [&]() {
+						return stop || next_chunk == std::size(chunks) || next_chunk < delivered + window;
+					});
+					if(stop || next_chunk == std::size(chunks))
+					{ return; }
+					index = next_chunk;
+					++next_chunk;
+				}
+
+				auto res = parse_ndjson_chunk(chunks[index], options.max_levels);
+				{
+					std::lock_guard lock{mtx};
+					results[index] = std::move(res);
+					ready.push_back(index);
+				}
+				cv.notify_all();
+			}
+		};
+
+		struct stop_on_exit
+		{
+			~stop_on_exit()
+			{
+				{
+					std::lock_guard lock{mtx};
+					stop = true;
+				}
+				cv.notify_all();
+			}
+
+			std::mutex& mtx;
+			std::condition_variable& cv;
+			bool& stop;
+		};
+
+		std::vector<std::jthread> workers;
+		stop_on_exit const stopper{mtx, cv, stop};
+		for(size_t k = 0; k != std::max(options.thread_count, size_t{1}); ++k)
+		{ workers.emplace_back(worker); }
+
+		size_t line_count = 0;
+		while(delivered != std::size(chunks))
+		{
+			ndjson_chunk_result current;
+			{
+				std::unique_lock lock{mtx};
+				if(options.order == delivery_order::input)
+				{
+					cv.wait(lock, [&]() { return results[delivered].has_value(); });
+					current = std::move(*results[delivered]);
+					results[delivered].reset();
+					ready.erase(std::find(std::begin(ready), std::end(ready), delivered));
+				}
+				else
+				{
+					cv.wait(lock, [&]() { return !ready.empty(); });
+					current = std::move(*results[ready.front()]);
+					results[ready.front()].reset();
+					ready.pop_front();
+				}
+				++delivered;
+			}
+			cv.notify_all();
+
+			for(auto& item : current.documents)
+			{ on_document(std::move(item)); }
+
+			if(current.ec != parser_error_code::completed)
+			{
+				auto const pos = get_text_position(std::data(input), current.error_pos);
+				return parse_result{current.error_ptr, current.ec, pos.line, pos.col};
+			}
+			line_count += current.line_count;
+		}
+
+		auto const end = std::data(input) + std::size(input);
+		auto const line_begin = std::find(std::make_reverse_iterator(end),
+			std::make_reverse_iterator(std::data(input)), '\n').base();
+		return parse_result{end, parser_error_code::completed, line_count + 1,
+			static_cast<size_t>(end - line_begin) + 1};
+	}
+}
+
+#endif
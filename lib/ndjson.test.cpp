@@ -0,0 +1,118 @@
+//@	{"target":{"name":"ndjson.test"}}
+
+#include "./ndjson.hpp"
+
+#include <testfwk/testfwk.hpp>
+
+#include <string>
+#include <vector>
+
+namespace
+{
+	std::string make_ndjson(size_t count)
+	{
+		std::string ret;
+		for(size_t k = 0; k != count; ++k)
+		{
+			ret.append("{\"seq\": ").append(std::to_string(k))
+				.append(", \"tags\": [\"a\", \"b\"], \"nested\": {\"value\": null}}\n");
+			if(k % 7 == 0)
+			{ ret.append("  \n"); }
+		}
+		return ret;
+	}
+
+	std::vector<size_t> collect_sequence(std::string_view input, jopp::ndjson_options const& options)
+	{
+		std::vector<size_t> ret;
+		auto const res = jopp::parse_ndjson(input, [&ret](jopp::ndjson_document&& doc) {
+			auto const& obj = *doc.root.get_if<jopp::object>();
+			EXPECT_EQ(obj.get_allocator().resource(), doc.arena.get());
+			ret.push_back(static_cast<size_t>(obj.get_field_as<jopp::number>("seq")));
+		}, options);
+		EXPECT_EQ(res.ec, jopp::parser_error_code::completed);
+		EXPECT_EQ(res.ptr, std::data(input) + std::size(input));
+		return ret;
+	}
+}
+
+TESTCASE(jopp_split_ndjson)
+{
+	std::string_view input{"{}\n[1, 2]\n{\"a\": 1}\n[]"};
+	auto const chunks = jopp::split_ndjson(input, 4);
+	REQUIRE_EQ(std::size(chunks), 3);
+	EXPECT_EQ(chunks[0], "{}\n[1, 2]\n");
+	EXPECT_EQ(chunks[1], "{\"a\": 1}\n");
+	EXPECT_EQ(chunks[2], "[]");
+
+	EXPECT_EQ(std::size(jopp::split_ndjson(input, 1)), 4);
+	EXPECT_EQ(std::size(jopp::split_ndjson(input, 1024)), 1);
+	EXPECT_EQ(std::size(jopp::split_ndjson(std::string_view{}, 1024)), 0);
+}
+
+TESTCASE(jopp_parse_ndjson_input_order)
+{
+	auto const input = make_ndjson(1000);
+	for(size_t threads : {1, 2, 4})
+	{
+		jopp::ndjson_options options;
+		options.thread_count = threads;
+		options.chunk_size = 512;
+		auto const seq = collect_sequence(input, options);
+		REQUIRE_EQ(std::size(seq), 1000);
+		for(size_t k = 0; k != std::size(seq); ++k)
+		{ EXPECT_EQ(seq[k], k); }
+	}
+}
+
+TESTCASE(jopp_parse_ndjson_completion_order)
+{
+	auto const input = make_ndjson(1000);
+	jopp::ndjson_options options;
+	options.thread_count = 4;
+	options.chunk_size = 512;
+	options.order = jopp::delivery_order::completion;
+	auto seq = collect_sequence(input, options);
+	REQUIRE_EQ(std::size(seq), 1000);
+	std::sort(std::begin(seq), std::end(seq));
+	for(size_t k = 0; k != std::size(seq); ++k)
+	{ EXPECT_EQ(seq[k], k); }
+}
+
+TESTCASE(jopp_parse_ndjson_error)
+{
+	auto input = make_ndjson(100);
+	input.append("{\"seq\": 100, \"tags\": [x]}\n");
+	input.append(make_ndjson(100));
+
+	jopp::ndjson_options options;
+	options.thread_count = 2;
+	options.chunk_size = 256;
+	size_t count = 0;
+	auto const res = jopp::parse_ndjson(input, [&count](jopp::ndjson_document&&) { ++count; }, options);
+	EXPECT_EQ(res.ec, jopp::parser_error_code::invalid_value);
+	EXPECT_EQ(res.line, 116);
+	EXPECT_EQ(res.col, 24);
+	EXPECT_EQ(count, 100);
+}
+
+TESTCASE(jopp_parse_ndjson_trailing_data)
+{
+	std::string_view input{"{\"a\": 1}\n{\"b\": 2} {\"c\": 3}\n"};
+	size_t count = 0;
+	auto const res = jopp::parse_ndjson(input, [&count](jopp::ndjson_document&&) { ++count; });
+	EXPECT_EQ(res.ec, jopp::parser_error_code::illegal_delimiter);
+	EXPECT_EQ(res.line, 2);
+	EXPECT_EQ(res.col, 10);
+	EXPECT_EQ(count, 1);
+}
+
+TESTCASE(jopp_parse_ndjson_incomplete_line)
+{
+	std::string_view input{"{\"a\": 1}\n{\"b\": [2, "};
+	size_t count = 0;
+	auto const res = jopp::parse_ndjson(input, [&count](jopp::ndjson_document&&) { ++count; });
+	EXPECT_EQ(res.ec, jopp::parser_error_code::more_data_needed);
+	EXPECT_EQ(res.ptr, std::data(input) + 9);
+	EXPECT_EQ(count, 1);
+}
@@ -0,0 +1,136 @@
+#ifndef JOPP_PARALLEL_PARSER_HPP
+#define JOPP_PARALLEL_PARSER_HPP
+
+#include "./fast_parser.hpp"
+
+#include <thread>
+#include <algorithm>
+#include <span>
+
+namespace jopp::inline JOPP_OBJECT_STORAGE_NAMESPACE
+{
+	struct parallel_parse_options
+	{
+		size_t thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+
+		// Smaller inputs are parsed sequentially
+		size_t min_size = 1024*1024;
+
+		std::optional<size_t> max_levels = 1024;
+
+		// Used from all threads at once, so it must be thread safe
+		std::pmr::memory_resource* resource = std::pmr::get_default_resource();
+	};
+
+	// Returns the position of a comma that may separate two elements of the top-level array, at or
+	// after begin, or end if there is none. The comma is only a candidate, as it may well be inside
+	// a string or a nested container. This is checked when the slices are parsed.
+	inline char const* find_split_candidate(char const* begin, char const* end)
+	{
+		auto const not_whitespace = [](char ch) { return !is_whitespace(ch); };
+		while(true)
+		{
+			auto const comma = std::find(begin, end, delimiters::value_separator);
+			if(comma == end)
+			{ return end; }
+
+			// Reject splits that would hide a missing element, as an empty slice is a valid array
+			auto const next = std::find_if(comma + 1, end, not_whitespace);
+			auto const prev = std::find_if(std::make_reverse_iterator(comma),
+				std::make_reverse_iterator(begin), not_whitespace);
+			if(next != end
+				&& *next != delimiters::value_separator && *next != delimiters::end_array
+				&& prev.base() != begin
+				&& *prev != delimiters::value_separator && *prev != delimiters::begin_array)
+			{ return comma; }
+
+			begin = comma + 1;
+		}
+	}
+
+	// Parses an input holding one large top-level array, by splitting it into slices that are
+	// parsed concurrently. The slices are parsed in place, as runs of array elements, and the
+	// elements are then spliced together. If any slice does not parse as a complete, non-empty
+	// run of elements, the split points were wrong (or the input is invalid), and the whole input
+	// is parsed again sequentially. Thus, the result, including the position of any error, is the
+	// same as from fast_parser.
+	inline parse_result<char const*> parse_parallel(std::string_view input,
+		container& root,
+		parallel_parse_options const& options = parallel_parse_options{})
+	{
+		auto const begin = std::data(input);
+		auto const end = begin + std::size(input);
+		auto const parse_sequentially = [&]() {
+			return fast_parser{root, options.max_levels, options.resource}.parse(input);
+		};
+
+		auto const doc_begin = std::find_if_not(begin, end, is_whitespace);
+		if(options.thread_count < 2 || std::size(input) < options.min_size
+			|| doc_begin == end || *doc_begin != delimiters::begin_array)
+		{ return parse_sequentially(); }
+
+		// Each slice starts just after the opening bracket, or a top-level comma. Except for the
+		// last one, each slice ends just after the comma that starts the next one.
+		std::vector<char const*> slice_begins{doc_begin + 1};
+		auto const slice_size = static_cast<size_t>(end - doc_begin)/options.thread_count;
+		for(size_t k = 1; k != options.thread_count; ++k)
+		{
+			auto const target = std::max(doc_begin + k*slice_size, slice_begins.back());
+			auto const comma = find_split_candidate(target, end);
+			if(comma == end)
+			{ break; }
+			slice_begins.push_back(comma + 1);
+		}
+		slice_begins.push_back(end);
+
+		struct slice_result
+		{
+			container root;
+			parse_result<char const*> res;
+		};
+		std::vector<slice_result> results(std::size(slice_begins) - 1);
+
+		auto const parse_slice = [&](size_t index) {
+			auto const is_last = index == std::size(results) - 1;
+			auto const slice = std::span{slice_begins[index], slice_begins[index + 1]};
+
+			auto& result = results[index];
+			auto const res = fast_parser{result.root, options.max_levels, options.resource}.parse_elements(slice);
+
+			// Only the last slice may end before the end of its input
+			auto const consumed_all = is_last || res.ptr == std::data(slice) + std::size(slice);
+			auto const items = result.root.get_if<array>();
+			result.res = parse_result{res.ptr,
+				res.ec == parser_error_code::completed && consumed_all && items != nullptr && !items->empty() ?
+					parser_error_code::completed : parser_error_code::invalid_value,
+				res.line,
+				res.col};
+		};
+
+		{
+			std::vector<std::jthread> workers;
+			for(size_t k = 1; k != std::size(results); ++k)
+			{ workers.emplace_back(parse_slice, k); }
+			parse_slice(0);
+		}
+
+		if(!std::all_of(std::begin(results), std::end(results), [](auto const& item) {
+			return item.res.ec == parser_error_code::completed;
+		}))
+		{ return parse_sequentially(); }
+
+		auto& items = *results[0].root.get_if<array>();
+		for(size_t k = 1; k != std::size(results); ++k)
+		{
+			for(auto& item : *results[k].root.get_if<array>())
+			{ items.push_back(std::move(item)); }
+		}
+		root = std::move(results[0].root);
+
+		auto const doc_end = results.back().res.ptr;
+		auto const pos = get_text_position(begin, doc_end - 1);
+		return parse_result{doc_end, parser_error_code::completed, pos.line, pos.col};
+	}
+}
+
+#endif
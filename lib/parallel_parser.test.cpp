@@ -0,0 +1,109 @@
+//@	{"target":{"name":"parallel_parser.test"}}
+
+#include "./parallel_parser.hpp"
+
+#include <testfwk/testfwk.hpp>
+
+#include <string>
+
+namespace
+{
+	std::string make_array(size_t count)
+	{
+		std::string ret{"[\n"};
+		for(size_t k = 0; k != count; ++k)
+		{
+			if(k != 0)
+			{ ret.append(",\n"); }
+			ret.append("\t{\"seq\": ").append(std::to_string(k))
+				.append(", \"text\": \"a, b, [c], {d}\", \"items\": [1, 2, {\"x\": [3, 4]}]}");
+		}
+		ret.append("\n]\n");
+		return ret;
+	}
+
+	jopp::parallel_parse_options make_options(size_t threads)
+	{
+		jopp::parallel_parse_options options;
+		options.thread_count = threads;
+		options.min_size = 0;
+		return options;
+	}
+
+	void check_same_as_sequential(std::string_view input, size_t threads)
+	{
+		jopp::container expected;
+		auto const expected_res = jopp::fast_parser{expected}.parse(input);
+
+		jopp::container root;
+		auto const res = jopp::parse_parallel(input, root, make_options(threads));
+		EXPECT_EQ(res.ec, expected_res.ec);
+		EXPECT_EQ(res.ptr, expected_res.ptr);
+		EXPECT_EQ(res.line, expected_res.line);
+		EXPECT_EQ(res.col, expected_res.col);
+	}
+}
+
+TESTCASE(jopp_find_split_candidate)
+{
+	std::string_view input{"[1, 2 ,, 3, ]"};
+	auto const begin = std::data(input);
+	auto const end = begin + std::size(input);
+	EXPECT_EQ(jopp::find_split_candidate(begin, end), begin + 2);
+	EXPECT_EQ(jopp::find_split_candidate(begin + 3, end), end);
+	EXPECT_EQ(jopp::find_split_candidate(begin, begin + 2), begin + 2);
+}
+
+TESTCASE(jopp_parse_parallel_valid_input)
+{
+	auto const input = make_array(1000);
+	for(size_t threads : {1, 2, 3, 8, 64})
+	{
+		jopp::container root;
+		auto const res = jopp::parse_parallel(input, root, make_options(threads));
+		EXPECT_EQ(res.ec, jopp::parser_error_code::completed);
+		EXPECT_EQ(res.ptr, std::data(input) + std::size(input) - 1);
+		EXPECT_EQ(res.line, 1002);
+		EXPECT_EQ(res.col, 1);
+
+		auto const& items = *root.get_if<jopp::array>();
+		REQUIRE_EQ(std::size(items), 1000);
+		for(size_t k = 0; k != std::size(items); ++k)
+		{
+			auto const& obj = *items[k].get_if<jopp::object>();
+			EXPECT_EQ(obj.get_field_as<jopp::number>("seq"), static_cast<jopp::number>(k));
+			EXPECT_EQ(obj.get_field_as<jopp::string>("text"), "a, b, [c], {d}");
+		}
+	}
+}
+
+TESTCASE(jopp_parse_parallel_falls_back_on_bad_split)
+{
+	// All commas are inside strings or nested containers, except one
+	std::string_view input{"[\"a, b, c, d, e, f, g, h, i, j\", [1, 2, 3, 4, 5, 6, 7, 8, 9]]"};
+	for(size_t threads : {2, 4, 16})
+	{
+		check_same_as_sequential(input, threads);
+		jopp::container root;
+		auto const res = jopp::parse_parallel(input, root, make_options(threads));
+		EXPECT_EQ(res.ec, jopp::parser_error_code::completed);
+		EXPECT_EQ(std::size(*root.get_if<jopp::array>()), 2);
+	}
+}
+
+TESTCASE(jopp_parse_parallel_errors)
+{
+	auto input = make_array(200);
+	check_same_as_sequential(input, 4);
+
+	for(std::string_view bad : {"[1, 2,, 3, 4, 5, 6]", "[1, 2, 3, 4, 5, 6,, ]", "[1, 2, [3, 4], x, 6]",
+		"[1, 2, \"3, 4, 5\", 6", "[1, 2, 3]]", "{\"a\": [1, 2, 3, 4]}", "[1, 2, 3, 4, 5, 6 7]"})
+	{
+		for(size_t threads : {2, 3, 5})
+		{ check_same_as_sequential(bad, threads); }
+	}
+
+	input.insert(std::size(input)/2, "x");
+	for(size_t threads : {2, 3, 5, 8})
+	{ check_same_as_sequential(input, threads); }
+}
@@ -6,12 +6,14 @@
 #include "./utils.hpp"
 
 #include <string_view>
-#include <stack>
 #include <span>
 #include <iterator>
 #include <format>
+#include <vector>
+#include <algorithm>
+#include <variant>
 
-namespace jopp
+namespace jopp::inline JOPP_OBJECT_STORAGE_NAMESPACE
 {
 	enum class parser_error_code
 	{
@@ -23,7 +25,8 @@ namespace jopp
 		illegal_delimiter,
 		invalid_value,
 		no_top_level_node,
-		nesting_level_too_deep
+		nesting_level_too_deep,
+		type_mismatch
 	};
 
 	inline constexpr char const* to_string(parser_error_code ec)
@@ -48,6 +51,8 @@ namespace jopp
 				return "No top level node";
 			case parser_error_code::nesting_level_too_deep:
 				return "Nesting level too deep";
+			case parser_error_code::type_mismatch:
+				return "Type mismatch";
 		}
 		__builtin_unreachable();
 	}
@@ -61,6 +66,20 @@ namespace jopp
 		size_t col;
 	};
 
+	struct text_position
+	{
+		size_t line;
+		size_t col;
+	};
+
+	inline text_position get_text_position(char const* begin, char const* pos)
+	{
+		auto const line = static_cast<size_t>(std::count(begin, pos, '\n')) + 1;
+		auto const line_begin = std::find(std::make_reverse_iterator(pos),
+			std::make_reverse_iterator(begin), '\n').base();
+		return text_position{line, static_cast<size_t>(pos - line_begin) + 1};
+	}
+
 	enum class parser_state
 	{
 		value,
@@ -92,7 +111,7 @@ namespace jopp
 		return parent.visit(
 			overload{
 				[](object& item, string&& key, class value&& val) {
-					if(!item.insert(std::move(key), std::move(val)).second)
+					if(!item.append(std::move(key), std::move(val)))
 					{
 						return store_value_result{
 							parser_state::after_value_object,
@@ -140,6 +159,14 @@ namespace jopp
 		return store_value(parent, std::move(key), to_value(std::move(child)));
 	}
 
+	inline parser_error_code sort_fields(container& item)
+	{
+		auto const obj = item.get_if<object>();
+		return obj == nullptr || obj->sort_fields() ?
+			parser_error_code::more_data_needed :
+			parser_error_code::key_already_exists;
+	}
+
 	template<class T>
 	concept parser_input_range = requires(T x)
 	{
@@ -148,39 +175,423 @@ namespace jopp
 		{ *std::begin(x) } -> std::convertible_to<char>;
 	};
 
-	class parser
+	template<class Callback>
+	inline parser_error_code invoke_event_callback(Callback&& cb)
+	{
+		if constexpr(std::is_void_v<std::invoke_result_t<Callback>>)
+		{
+			cb();
+			return parser_error_code::more_data_needed;
+		}
+		else
+		{ return cb(); }
+	}
+
+	template<class T>
+	concept event_callback_result = std::is_void_v<T> || std::is_same_v<T, parser_error_code>;
+
+	template<class T>
+	concept event_handler = requires(T& handler, std::string_view str, number num, boolean b)
+	{
+		requires event_callback_result<decltype(handler.on_begin_object())>;
+		requires event_callback_result<decltype(handler.on_end_object())>;
+		requires event_callback_result<decltype(handler.on_begin_array())>;
+		requires event_callback_result<decltype(handler.on_end_array())>;
+		requires event_callback_result<decltype(handler.on_key(str))>;
+		requires event_callback_result<decltype(handler.on_string(str))>;
+		requires event_callback_result<decltype(handler.on_number(num))>;
+		requires event_callback_result<decltype(handler.on_boolean(b))>;
+		requires event_callback_result<decltype(handler.on_null())>;
+	};
+
+	// Selects, at compile time, what the parser keeps track of. Anything that is disabled is left out
+	// of the parse loop.
+	struct default_parser_policy
+	{
+		// Without position tracking, line and col are zero in parse_result. For contiguous input,
+		// they can be found afterwards with get_text_position.
+		static constexpr bool track_position = true;
+
+		// Without a depth limit, max_levels is ignored
+		static constexpr bool limit_depth = true;
+
+		// Without this, a duplicated key is not an error. Only turn it off for input known not to
+		// have any, as which of the values a lookup finds is unspecified.
+		static constexpr bool reject_duplicate_keys = true;
+	};
+
+	// Only for trusted input. Without a depth limit, a deeply nested document can build a tree
+	// that overflows the stack when it is destroyed, since values are destroyed recursively.
+	struct unchecked_parser_policy
+	{
+		static constexpr bool track_position = false;
+		static constexpr bool limit_depth = false;
+		static constexpr bool reject_duplicate_keys = false;
+	};
+
+	template<class T>
+	concept parser_policy = requires
+	{
+		{ T::track_position } -> std::convertible_to<bool>;
+		{ T::limit_depth } -> std::convertible_to<bool>;
+		{ T::reject_duplicate_keys } -> std::convertible_to<bool>;
+	};
+
+	template<class Handler, class Policy = default_parser_policy>
+	requires event_handler<std::remove_reference_t<Handler>> && parser_policy<Policy>
+	class event_parser
 	{
 	public:
-		explicit parser(container& root, std::optional<size_t> max_levels = 1024):
-			m_line{1},
-			m_col{1},
+		template<class ... Args>
+		explicit event_parser(std::optional<size_t> max_levels, Args&& ... args):
+			m_line{first_line},
+			m_col{first_col},
 			m_current_state{parser_state::value},
 			m_max_levels{max_levels},
-			m_root{root}
+			m_handler{std::forward<Args>(args)...}
 		{}
 
 		template<parser_input_range InputSeq>
 		auto parse(InputSeq input_seq);
 
-		container const& root() const
-		{ return m_root; }
-
 		auto current_depth() const
-		{ return m_contexts.size(); }
+		{ return m_levels.size(); }
+
+		// Prepares for a new document. The handler is left as is. Allocated buffers are kept.
+		void reset()
+		{
+			m_line = first_line;
+			m_col = first_col;
+			m_current_state = parser_state::value;
+			m_levels.clear();
+			m_buffer.clear();
+		}
+
+		auto& handler()
+		{ return m_handler; }
+
+		auto const& handler() const
+		{ return m_handler; }
 
 	private:
+		static constexpr size_t first_line = Policy::track_position ? 1 : 0;
+		static constexpr size_t first_col = Policy::track_position ? 1 : 0;
+
+		bool depth_limit_reached() const
+		{
+			if constexpr(Policy::limit_depth)
+			{ return m_max_levels.has_value() && std::size(m_levels) == *m_max_levels; }
+			else
+			{ return false; }
+		}
+
+		void advance_col(size_t n)
+		{
+			if constexpr(Policy::track_position)
+			{ m_col += n; }
+		}
+
+		template<class InputIterator>
+		InputIterator append_string_run(InputIterator ptr, InputIterator end);
+
+		template<class InputIterator>
+		InputIterator append_literal_run(InputIterator ptr, InputIterator end);
+
+		parser_error_code emit_literal(std::string_view literal);
+
+		template<class Callback>
+		parser_error_code emit_value(Callback&& cb);
+
+		parser_error_code emit_end(parser_state container_state);
+
 		size_t m_line;
 		size_t m_col;
 		parser_state m_current_state;
 		std::optional<size_t> m_max_levels;
-		std::stack<parser_context> m_contexts;
-		string m_buffer;
+		std::vector<parser_state> m_levels;
+		std::string m_buffer;
+		Handler m_handler;
+	};
+
+	// Builds the tree in place: a nested container is inserted into its parent when it begins,
+	// and values are then stored directly into it
+	template<parser_policy Policy = default_parser_policy>
+	class basic_dom_builder
+	{
+	public:
+		explicit basic_dom_builder(container& root,
+			std::pmr::memory_resource* resource = std::pmr::get_default_resource()):
+			m_root{root},
+			m_resource{resource}
+		{}
+
+		parser_error_code on_begin_object()
+		{ return begin_container<object>(); }
+
+		parser_error_code on_begin_array()
+		{ return begin_container<array>(); }
+
+		parser_error_code on_end_object()
+		{ return end_container(); }
+
+		parser_error_code on_end_array()
+		{ return end_container(); }
+
+		parser_error_code on_key(std::string_view key)
+		{
+			m_contexts.back().key = key;
+			return parser_error_code::more_data_needed;
+		}
+
+		parser_error_code on_key(string&& key)
+		{
+			m_contexts.back().key = std::move(key);
+			return parser_error_code::more_data_needed;
+		}
+
+		parser_error_code on_string(std::string_view val)
+		{ return on_value(value{string{val, m_resource}}); }
+
+		parser_error_code on_number(number val)
+		{ return on_value(value{val}); }
+
+		parser_error_code on_boolean(boolean val)
+		{ return on_value(value{val}); }
+
+		parser_error_code on_null()
+		{ return on_value(value{null{}}); }
+
+		parser_error_code on_value(value&& val)
+		{
+			auto const res = store(val);
+			return Policy::reject_duplicate_keys ? res : parser_error_code::more_data_needed;
+		}
+
+		size_t depth() const
+		{ return std::size(m_contexts); }
+
+		void reset(container& root)
+		{
+			m_contexts.clear();
+			m_root = root;
+		}
+
+		bool in_array() const
+		{ return std::holds_alternative<array*>(m_contexts.back().target); }
+
+		container const& root() const
+		{ return m_root; }
+
+		std::pmr::memory_resource* resource() const
+		{ return m_resource; }
+
+	private:
+		struct context
+		{
+			string key;
+			std::variant<object*, array*> target;
+			// Holds a container whose key already exists in the parent, so that the error can be
+			// reported when it closes
+			value detached;
+		};
+
+		// Leaves val untouched if its key already exists
+		parser_error_code store(value& val)
+		{
+			auto& current = m_contexts.back();
+			if(auto const obj = std::get_if<object*>(&current.target); obj != nullptr)
+			{
+				auto const inserted = (*obj)->append(std::move(current.key), std::move(val));
+				current.key.clear();
+				return inserted ? parser_error_code::more_data_needed : parser_error_code::key_already_exists;
+			}
+
+			std::get<array*>(current.target)->push_back(std::move(val));
+			return parser_error_code::more_data_needed;
+		}
+
+		template<class T>
+		parser_error_code begin_container()
+		{
+			if(m_contexts.empty())
+			{
+				m_top_level = container{T{m_resource}};
+				m_contexts.push_back(context{string{m_resource}, m_top_level.get_if<T>(), value{}});
+				return parser_error_code::more_data_needed;
+			}
+
+			// The child is boxed, so its address survives the parent growing
+			value child{T{m_resource}};
+			auto const target = child.get_if<T>();
+			if(store(child) == parser_error_code::more_data_needed)
+			{ child = value{}; }
+			m_contexts.push_back(context{string{m_resource}, target, std::move(child)});
+			return parser_error_code::more_data_needed;
+		}
+
+		parser_error_code end_container()
+		{
+			auto& current = m_contexts.back();
+			if(auto const obj = std::get_if<object*>(&current.target);
+				obj != nullptr && !(*obj)->sort_fields() && Policy::reject_duplicate_keys)
+			{ return parser_error_code::key_already_exists; }
+
+			auto const detached = !is_null(current.detached);
+			m_contexts.pop_back();
+			if(detached && Policy::reject_duplicate_keys)
+			{ return parser_error_code::key_already_exists; }
+
+			if(m_contexts.empty())
+			{ m_root.get() = std::move(m_top_level); }
+
+			return parser_error_code::more_data_needed;
+		}
+
+		std::vector<context> m_contexts;
+		container m_top_level;
 		std::reference_wrapper<container> m_root;
+		std::pmr::memory_resource* m_resource;
 	};
+
+	using dom_builder = basic_dom_builder<>;
+
+	template<parser_policy Policy = default_parser_policy>
+	class basic_parser
+	{
+	public:
+		explicit basic_parser(container& root,
+			std::optional<size_t> max_levels = 1024,
+			std::pmr::memory_resource* resource = std::pmr::get_default_resource()):
+			m_impl{max_levels, root, resource}
+		{}
+
+		template<parser_input_range InputSeq>
+		auto parse(InputSeq input_seq)
+		{ return m_impl.parse(input_seq); }
+
+		container const& root() const
+		{ return m_impl.handler().root(); }
+
+		auto current_depth() const
+		{ return m_impl.current_depth(); }
+
+		std::pmr::memory_resource* resource() const
+		{ return m_impl.handler().resource(); }
+
+		// Prepares for parsing a new document into root. This is cheaper than constructing a new
+		// parser, since buffers already allocated are kept.
+		void reset(container& root)
+		{
+			m_impl.reset();
+			m_impl.handler().reset(root);
+		}
+
+	private:
+		event_parser<basic_dom_builder<Policy>, Policy> m_impl;
+	};
+
+	using parser = basic_parser<>;
+}
+
+template<class Handler, class Policy>
+requires jopp::event_handler<std::remove_reference_t<Handler>> && jopp::parser_policy<Policy>
+template<class InputIterator>
+InputIterator jopp::event_parser<Handler, Policy>::append_string_run(InputIterator ptr, InputIterator end)
+{
+	if constexpr(std::contiguous_iterator<InputIterator>
+		&& std::is_same_v<std::iter_value_t<InputIterator>, char>)
+	{
+		char const* const run_begin = std::to_address(ptr);
+		auto const run_end = find_char_to_escape(run_begin, std::to_address(end));
+		auto const n = run_end - run_begin;
+		m_buffer.append(run_begin, run_end);
+		advance_col(static_cast<size_t>(n));
+		return ptr + n;
+	}
+	else
+	{ return ptr; }
+}
+
+template<class Handler, class Policy>
+requires jopp::event_handler<std::remove_reference_t<Handler>> && jopp::parser_policy<Policy>
+template<class InputIterator>
+InputIterator jopp::event_parser<Handler, Policy>::append_literal_run(InputIterator ptr, InputIterator end)
+{
+	if constexpr(std::contiguous_iterator<InputIterator>
+		&& std::is_same_v<std::iter_value_t<InputIterator>, char>)
+	{
+		char const* const run_begin = std::to_address(ptr);
+		auto const run_end = find_literal_end(run_begin, std::to_address(end));
+		auto const n = run_end - run_begin;
+		m_buffer.append(run_begin, run_end);
+		advance_col(static_cast<size_t>(n));
+		return ptr + n;
+	}
+	else
+	{ return ptr; }
 }
 
+template<class Handler, class Policy>
+requires jopp::event_handler<std::remove_reference_t<Handler>> && jopp::parser_policy<Policy>
+template<class Callback>
+jopp::parser_error_code jopp::event_parser<Handler, Policy>::emit_value(Callback&& cb)
+{
+	auto const res = invoke_event_callback(std::forward<Callback>(cb));
+	m_current_state = m_levels.back();
+	return res;
+}
+
+template<class Handler, class Policy>
+requires jopp::event_handler<std::remove_reference_t<Handler>> && jopp::parser_policy<Policy>
+jopp::parser_error_code jopp::event_parser<Handler, Policy>::emit_literal(std::string_view literal)
+{
+	switch(literal.empty() ? '\0' : literal.front())
+	{
+		case 'f':
+			if(literal != false_literal)
+			{ return parser_error_code::invalid_value; }
+			return emit_value([this](){ return m_handler.on_boolean(false); });
+
+		case 't':
+			if(literal != true_literal)
+			{ return parser_error_code::invalid_value; }
+			return emit_value([this](){ return m_handler.on_boolean(true); });
+
+		case 'n':
+			if(literal == null_literal)
+			{ return emit_value([this](){ return m_handler.on_null(); }); }
+			break;
+	}
+
+	if(auto val = to_number(literal); val.has_value())
+	{ return emit_value([this, val = *val](){ return m_handler.on_number(val); }); }
+
+	return parser_error_code::invalid_value;
+}
+
+template<class Handler, class Policy>
+requires jopp::event_handler<std::remove_reference_t<Handler>> && jopp::parser_policy<Policy>
+jopp::parser_error_code jopp::event_parser<Handler, Policy>::emit_end(parser_state container_state)
+{
+	m_levels.pop_back();
+	auto const res = container_state == parser_state::after_value_object ?
+		invoke_event_callback([this](){ return m_handler.on_end_object(); }) :
+		invoke_event_callback([this](){ return m_handler.on_end_array(); });
+
+	if(res != parser_error_code::more_data_needed)
+	{ return res; }
+
+	if(m_levels.empty())
+	{ return parser_error_code::completed; }
+
+	m_current_state = m_levels.back();
+	return res;
+}
+
+template<class Handler, class Policy>
+requires jopp::event_handler<std::remove_reference_t<Handler>> && jopp::parser_policy<Policy>
 template<jopp::parser_input_range InputSeq>
-auto jopp::parser::parse(InputSeq input_seq)
+auto jopp::event_parser<Handler, Policy>::parse(InputSeq input_seq)
 {
 	auto ptr = std::begin(input_seq);
 	while(true)
@@ -198,28 +609,40 @@ auto jopp::parser::parse(InputSeq input_seq)
 				switch(ch_in)
 				{
 					case delimiters::begin_array:
-						if(m_max_levels.has_value() && std::size(m_contexts) == *m_max_levels)
+					{
+						if(depth_limit_reached())
 						{ return parse_result{ptr, parser_error_code::nesting_level_too_deep, m_line, m_col }; }
-						m_contexts.push(parser_context{});
-						m_contexts.top().value = container{array{}};
+						m_levels.push_back(parser_state::after_value_array);
+						auto const res = invoke_event_callback([this](){ return m_handler.on_begin_array(); });
+						if(res != parser_error_code::more_data_needed)
+						{ return parse_result{ptr, res, m_line, m_col}; }
 						m_current_state = parser_state::value;
 						break;
+					}
 
 					case delimiters::begin_object:
-						if(m_max_levels.has_value() && std::size(m_contexts) == *m_max_levels)
+					{
+						if(depth_limit_reached())
 						{ return parse_result{ptr, parser_error_code::nesting_level_too_deep, m_line, m_col }; }
-						m_contexts.push(parser_context{});
-						m_contexts.top().value = container{object{}};
+						m_levels.push_back(parser_state::after_value_object);
+						auto const res = invoke_event_callback([this](){ return m_handler.on_begin_object(); });
+						if(res != parser_error_code::more_data_needed)
+						{ return parse_result{ptr, res, m_line, m_col}; }
 						m_current_state = parser_state::before_key;
 						break;
+					}
 
 					case delimiters::end_array:
+						if(std::size(m_levels) == 0)
+						{ return parse_result{ptr, parser_error_code::no_top_level_node, m_line, m_col}; }
+						if(m_levels.back() != parser_state::after_value_array)
+						{ return parse_result{ptr, parser_error_code::illegal_delimiter, m_line, m_col}; }
 						m_current_state = parser_state::after_value_array;
 						--ptr;
 						break;
 
 					case delimiters::string_begin_end:
-						if(std::size(m_contexts) == 0)
+						if(std::size(m_levels) == 0)
 						{ return parse_result{ptr, parser_error_code::no_top_level_node, m_line, m_col}; }
 						m_current_state = parser_state::string_value;
 						break;
@@ -227,11 +650,35 @@ auto jopp::parser::parse(InputSeq input_seq)
 					default:
 						if(!is_whitespace(ch_in))
 						{
-							if(std::size(m_contexts) == 0)
+							if(std::size(m_levels) == 0)
 							{ return parse_result{ptr, parser_error_code::no_top_level_node, m_line, m_col}; }
 
+							if constexpr(std::contiguous_iterator<decltype(ptr)>
+								&& std::is_same_v<std::iter_value_t<decltype(ptr)>, char>)
+							{
+								// If the whole literal is in this chunk, classify it in place
+								auto const literal_begin = std::to_address(old_pos);
+								auto const literal_end = find_literal_end(literal_begin + 1,
+									std::to_address(std::end(input_seq)));
+								if(literal_end != std::to_address(std::end(input_seq)))
+								{
+									auto const n = static_cast<size_t>(literal_end - literal_begin);
+									auto const res = emit_literal(std::string_view{literal_begin, literal_end});
+									if(res != parser_error_code::more_data_needed)
+									{
+										advance_col(n);
+										return parse_result{old_pos + n + 1, res, m_line, m_col};
+									}
+
+									advance_col(n - 1);
+									ptr = old_pos + n;
+									break;
+								}
+							}
+
 							m_buffer += ch_in;
 							m_current_state = parser_state::literal;
+							ptr = append_literal_run(ptr, std::end(input_seq));
 						}
 				}
 				break;
@@ -242,21 +689,20 @@ auto jopp::parser::parse(InputSeq input_seq)
 					|| ch_in == delimiters::end_object
 					|| is_whitespace(ch_in))
 				{
-					auto res = store_value(m_contexts.top().value,
-						std::move(m_contexts.top().key),
-						literal_view{m_buffer});
-					if(res.err != parser_error_code::more_data_needed)
-					{ return parse_result{ptr, res.err, m_line, m_col}; }
+					auto const res = emit_literal(m_buffer);
+					if(res != parser_error_code::more_data_needed)
+					{ return parse_result{ptr, res, m_line, m_col}; }
 
 					if(!is_whitespace(ch_in))
 					{ --ptr; }
 
-					m_current_state = res.next_state;
-					m_buffer = string{};
-					m_contexts.top().key = string{};
+					m_buffer.clear();
 				}
 				else
-				{ m_buffer += ch_in; }
+				{
+					m_buffer += ch_in;
+					ptr = append_literal_run(ptr, std::end(input_seq));
+				}
 				break;
 
 			case parser_state::string_value:
@@ -264,15 +710,11 @@ auto jopp::parser::parse(InputSeq input_seq)
 				{
 					case delimiters::string_begin_end:
 					{
-						auto res = store_value(m_contexts.top().value,
-							std::move(m_contexts.top().key),
-							value{m_buffer});
-						if(res.err != parser_error_code::more_data_needed)
-						{ return parse_result{ptr, res.err, m_line, m_col}; }
-
-						m_current_state = res.next_state;
-						m_contexts.top().key = string{};
-						m_buffer = string{};
+						auto const res = emit_value([this](){ return m_handler.on_string(m_buffer); });
+						if(res != parser_error_code::more_data_needed)
+						{ return parse_result{ptr, res, m_line, m_col}; }
+
+						m_buffer.clear();
 						break;
 					}
 
@@ -284,7 +726,10 @@ auto jopp::parser::parse(InputSeq input_seq)
 						if(char_should_be_escaped(ch_in))
 						{ return parse_result{ptr, parser_error_code::character_must_be_escaped, m_line, m_col}; }
 						else
-						{ m_buffer += ch_in; }
+						{
+							m_buffer += ch_in;
+							ptr = append_string_run(ptr, std::end(input_seq));
+						}
 				}
 				break;
 
@@ -320,10 +765,14 @@ auto jopp::parser::parse(InputSeq input_seq)
 				switch(ch_in)
 				{
 					case delimiters::string_begin_end:
-						m_contexts.top().key = std::move(m_buffer);
-						m_buffer = string{};
+					{
+						auto const res = invoke_event_callback([this](){ return m_handler.on_key(m_buffer); });
+						if(res != parser_error_code::more_data_needed)
+						{ return parse_result{ptr, res, m_line, m_col}; }
+						m_buffer.clear();
 						m_current_state = parser_state::before_value;
 						break;
+					}
 
 					case begin_esc_seq:
 						m_current_state = parser_state::key_esc_seq;
@@ -333,7 +782,10 @@ auto jopp::parser::parse(InputSeq input_seq)
 						if(char_should_be_escaped(ch_in))
 						{ return parse_result{ptr, parser_error_code::character_must_be_escaped, m_line, m_col}; }
 						else
-						{ m_buffer += ch_in; }
+						{
+							m_buffer += ch_in;
+							ptr = append_string_run(ptr, std::end(input_seq));
+						}
 				}
 				break;
 
@@ -365,20 +817,9 @@ auto jopp::parser::parse(InputSeq input_seq)
 				{
 					case delimiters::end_object:
 					{
-						auto current_context = std::move(m_contexts.top());
-						m_contexts.pop();
-						if(std::size(m_contexts) == 0)
-						{
-							m_root.get() = std::move(current_context.value);
-							return parse_result{ptr, parser_error_code::completed, m_line, m_col};
-						}
-
-						auto const res = store_value(m_contexts.top().value,
-							std::move(m_contexts.top().key),
-							std::move(current_context.value));
-						if(res.err != parser_error_code::more_data_needed)
-						{ return parse_result{ptr, res.err, m_line, m_col}; }
-						m_current_state = res.next_state;
+						auto const res = emit_end(parser_state::after_value_object);
+						if(res != parser_error_code::more_data_needed)
+						{ return parse_result{ptr, res, m_line, m_col}; }
 						break;
 					}
 
@@ -397,17 +838,9 @@ auto jopp::parser::parse(InputSeq input_seq)
 				{
 					case delimiters::end_array:
 					{
-						auto current_context = std::move(m_contexts.top());
-						m_contexts.pop();
-						if(m_contexts.empty())
-						{
-							m_root.get() = std::move(current_context.value);
-							return parse_result{ptr, parser_error_code::completed, m_line, m_col};
-						}
-
-						m_current_state = store_value(m_contexts.top().value,
-							std::move(m_contexts.top().key),
-							std::move(current_context.value)).next_state;
+						auto const res = emit_end(parser_state::after_value_array);
+						if(res != parser_error_code::more_data_needed)
+						{ return parse_result{ptr, res, m_line, m_col}; }
 						break;
 					}
 
@@ -422,25 +855,36 @@ auto jopp::parser::parse(InputSeq input_seq)
 				break;
 		}
 
-		if(ptr != old_pos)
+		if constexpr(Policy::track_position)
 		{
-			if(ch_in == '\n')
+			if(ptr != old_pos)
 			{
-				m_col = 0;
-				++m_line;
+				if(ch_in == '\n')
+				{
+					m_col = 0;
+					++m_line;
+				}
+				++m_col;
 			}
-			++m_col;
+		}
+
+		if constexpr(requires(Handler const& handler){ {handler.pause_requested()} -> std::same_as<bool>; })
+		{
+			if(m_handler.pause_requested())
+			{ return parse_result{ptr, parser_error_code::more_data_needed, m_line, m_col}; }
 		}
 	}
 }
 
-namespace jopp
+namespace jopp::inline JOPP_OBJECT_STORAGE_NAMESPACE
 {
 	template<parser_input_range InputSeq>
-	auto parse(InputSeq input_seq, std::optional<size_t> max_levels = 1024)
+	auto parse(InputSeq input_seq,
+		std::optional<size_t> max_levels = 1024,
+		std::pmr::memory_resource* resource = std::pmr::get_default_resource())
 	{
 		container output_object;
-		parser parser{output_object};
+		parser parser{output_object, max_levels, resource};
 		auto const result = parser.parse(input_seq);
 		if(result.ec != parser_error_code::completed)
 		{
@@ -17,6 +17,7 @@ TESTCASE(jopp_parser_error_code_to_string)
 	EXPECT_EQ(to_string(jopp::parser_error_code::invalid_value), std::string_view{"Invalid value"});
 	EXPECT_EQ(to_string(jopp::parser_error_code::no_top_level_node), std::string_view{"No top level node"});
 	EXPECT_EQ(to_string(jopp::parser_error_code::nesting_level_too_deep), std::string_view{"Nesting level too deep"});
+	EXPECT_EQ(to_string(jopp::parser_error_code::type_mismatch), std::string_view{"Type mismatch"});
 
 }
 
@@ -590,4 +591,378 @@ TESTCASE(jopp_parser_recursion_level_exceeded_object)
 	EXPECT_EQ(*res.ptr, '"');
 	EXPECT_EQ(res.line, 1);
 	EXPECT_EQ(res.col, 7);
-}
\ No newline at end of file
+}
+
+namespace
+{
+	std::string make_long_string(size_t length, std::string_view escape_sequence)
+	{
+		std::string ret;
+		for(size_t k = 0; k != length; ++k)
+		{
+			if(k % 97 == 96)
+			{ ret.append(escape_sequence); }
+			else
+			{ ret += static_cast<char>('a' + k % 26); }
+		}
+		return ret;
+	}
+}
+
+TESTCASE(jopp_parser_long_strings_any_block_size)
+{
+	auto const key = make_long_string(300, "\\t");
+	auto const value = make_long_string(500, "\\\"");
+	auto const data = std::string{"{\""}.append(key).append("\": [\"").append(value).append("\"]}");
+
+	auto const expected_key = make_long_string(300, "\t");
+	auto const expected_value = make_long_string(500, "\"");
+
+	for(size_t block_size = 1; block_size != std::size(data) + 1; ++block_size)
+	{
+		jopp::container val;
+		jopp::parser parser{val};
+		auto ptr = std::data(data);
+		auto const end = ptr + std::size(data);
+		while(true)
+		{
+			auto const n = std::min(block_size, static_cast<size_t>(end - ptr));
+			std::span const input{ptr, n};
+			auto const res = parser.parse(input);
+			if(res.ec == jopp::parser_error_code::completed)
+			{
+				EXPECT_EQ(res.ptr, std::end(input));
+				EXPECT_EQ(res.line, 1);
+				EXPECT_EQ(res.col, std::size(data));
+				break;
+			}
+			REQUIRE_EQ(res.ec, jopp::parser_error_code::more_data_needed);
+			ptr += n;
+		}
+
+		auto const& root = val.get<jopp::object>();
+		REQUIRE_EQ(std::size(root), 1);
+		EXPECT_EQ(std::string_view{root.begin()->first}, expected_key);
+		auto const& array = root.begin()->second.get<jopp::array>();
+		REQUIRE_EQ(std::size(array), 1);
+		EXPECT_EQ(std::string_view{array[0].get<jopp::string>()}, expected_value);
+	}
+}
+
+TESTCASE(jopp_parser_literals_any_block_size)
+{
+	std::string_view const data{R"({"a": [true, false, null, 123.5e-3, -7, nan, truly, 1e1000]})"};
+
+	jopp::container expected_val;
+	jopp::parser expected_parser{expected_val};
+	auto const expected = expected_parser.parse(data);
+	EXPECT_EQ(expected.ec, jopp::parser_error_code::invalid_value);
+
+	for(size_t block_size = 1; block_size != std::size(data) + 1; ++block_size)
+	{
+		jopp::container val;
+		jopp::parser parser{val};
+		auto ptr = std::data(data);
+		auto const end = ptr + std::size(data);
+		while(true)
+		{
+			auto const n = std::min(block_size, static_cast<size_t>(end - ptr));
+			auto const res = parser.parse(std::span{ptr, n});
+			if(res.ec != jopp::parser_error_code::more_data_needed)
+			{
+				EXPECT_EQ(res.ec, expected.ec);
+				EXPECT_EQ(std::to_address(res.ptr), std::to_address(expected.ptr));
+				EXPECT_EQ(res.line, expected.line);
+				EXPECT_EQ(res.col, expected.col);
+				break;
+			}
+			REQUIRE_NE(n, 0);
+			ptr += n;
+		}
+	}
+}
+
+TESTCASE(jopp_parser_long_string_missing_esc_char)
+{
+	auto value = make_long_string(500, "\\n");
+	value[200] = '\n';
+	auto const data = std::string{"[\""}.append(value).append("\"]");
+
+	jopp::container val;
+	jopp::parser parser{val};
+	auto const res = parser.parse(std::string_view{data});
+	EXPECT_EQ(res.ec, jopp::parser_error_code::character_must_be_escaped);
+	EXPECT_EQ(res.ptr, std::data(data) + 203);
+	EXPECT_EQ(res.line, 1);
+	EXPECT_EQ(res.col, 203);
+}
+
+TESTCASE(jopp_parser_closing_bracket_in_wrong_context)
+{
+	{
+		jopp::container val;
+		jopp::parser parser{val};
+		std::string_view data{"]"};
+		auto const res = parser.parse(data);
+		EXPECT_EQ(res.ec, jopp::parser_error_code::no_top_level_node);
+		EXPECT_EQ(res.ptr, std::data(data) + 1);
+	}
+
+	{
+		jopp::container val;
+		jopp::parser parser{val};
+		std::string_view data{R"({"key": ])"};
+		auto const res = parser.parse(data);
+		EXPECT_EQ(res.ec, jopp::parser_error_code::illegal_delimiter);
+		EXPECT_EQ(res.col, 9);
+	}
+}
+
+TESTCASE(jopp_parser_store_array_duplicate_key)
+{
+	jopp::container val;
+	jopp::parser parser{val};
+	std::string_view data{R"({"key a": 456, "key a": []})"};
+
+	auto const res = parser.parse(data);
+	EXPECT_EQ(res.ec, jopp::parser_error_code::key_already_exists);
+	EXPECT_EQ(res.col, 26);
+}
+
+namespace
+{
+	struct event_recorder
+	{
+		void on_begin_object() { events += "{"; }
+		void on_end_object() { events += "}"; }
+		void on_begin_array() { events += "["; }
+		void on_end_array() { events += "]"; }
+		void on_key(std::string_view key) { events.append("k:").append(key).append(" "); }
+		void on_string(std::string_view str) { events.append("s:").append(str).append(" "); }
+		void on_number(jopp::number val) { events.append("n:").append(jopp::to_string(val)).append(" "); }
+		void on_boolean(jopp::boolean val) { events.append("b:").append(jopp::to_string(val)).append(" "); }
+		void on_null() { events.append("null "); }
+
+		std::string events;
+	};
+
+	struct number_summer
+	{
+		jopp::parser_error_code on_begin_object() { return jopp::parser_error_code::more_data_needed; }
+		jopp::parser_error_code on_end_object() { return jopp::parser_error_code::more_data_needed; }
+		jopp::parser_error_code on_begin_array() { return jopp::parser_error_code::more_data_needed; }
+		jopp::parser_error_code on_end_array() { return jopp::parser_error_code::more_data_needed; }
+		jopp::parser_error_code on_key(std::string_view) { return jopp::parser_error_code::more_data_needed; }
+		jopp::parser_error_code on_string(std::string_view) { return jopp::parser_error_code::invalid_value; }
+		jopp::parser_error_code on_number(jopp::number val)
+		{
+			sum += val;
+			return jopp::parser_error_code::more_data_needed;
+		}
+		jopp::parser_error_code on_boolean(jopp::boolean) { return jopp::parser_error_code::invalid_value; }
+		jopp::parser_error_code on_null() { return jopp::parser_error_code::invalid_value; }
+
+		jopp::number sum{};
+	};
+}
+
+TESTCASE(jopp_event_parser_parse_data_multiple_blocks)
+{
+	jopp::event_parser<event_recorder> parser{1024};
+
+	auto ptr = std::begin(json_test_data);
+	while(true)
+	{
+		auto const bytes_to_process = std::min(static_cast<size_t>(std::end(json_test_data) - ptr),
+			static_cast<size_t>(7));
+		auto res = parser.parse(std::string_view{ptr, bytes_to_process});
+		ptr += bytes_to_process;
+		if(res.ec == jopp::parser_error_code::completed)
+		{
+			EXPECT_EQ(*res.ptr, 'S');
+			break;
+		}
+		REQUIRE_EQ(res.ec, jopp::parser_error_code::more_data_needed);
+	}
+
+	EXPECT_EQ(parser.current_depth(), 0);
+	EXPECT_EQ(parser.handler().events, "{k:empty object {}k:empty array []k:had {k:tightly [[n:4 n:2 n:3 n:1 ]"
+		"s:feet b:true n:2145719840.4312375 n:-286229488 b:true b:true {k:object in array s:bar }"
+		"{k:object with literal last null }]k:sound b:false k:eaten b:false k:pull n:1285774482.782745 "
+		"k:long n:-1437168945.8634152 k:independent n:-1451031326 k:repeated end {k:value n:46 }}"
+		"k:fireplace n:720535269 k:refused s:better k:wood s:involved k:without b:true k:it b:false "
+		"k:testing null null k:a key with esc seq\n\t\\foo\" s:A value with esc seq\n\t\\foo\" }");
+}
+
+TESTCASE(jopp_event_parser_handler_error)
+{
+	jopp::event_parser<number_summer> parser{1024};
+	std::string_view data{R"([1, 2, [3, 4], "five", 6])"};
+	auto const res = parser.parse(data);
+	EXPECT_EQ(res.ec, jopp::parser_error_code::invalid_value);
+	EXPECT_EQ(res.ptr, std::data(data) + 21);
+	EXPECT_EQ(parser.handler().sum, 10.0);
+}
+
+TESTCASE(jopp_event_parser_handler_by_reference)
+{
+	number_summer summer;
+	jopp::event_parser<number_summer&> parser{1024, summer};
+	auto const res = parser.parse(std::string_view{R"({"a": 1, "b": [2, 3], "c": {"d": 4}})"});
+	EXPECT_EQ(res.ec, jopp::parser_error_code::completed);
+	EXPECT_EQ(summer.sum, 10.0);
+}
+
+namespace
+{
+	class default_resource_override
+	{
+	public:
+		explicit default_resource_override(std::pmr::memory_resource* resource):
+			m_old_resource{std::pmr::set_default_resource(resource)}
+		{}
+
+		~default_resource_override()
+		{ std::pmr::set_default_resource(m_old_resource); }
+
+		default_resource_override(default_resource_override const&) = delete;
+		default_resource_override& operator=(default_resource_override const&) = delete;
+
+	private:
+		std::pmr::memory_resource* m_old_resource;
+	};
+}
+
+TESTCASE(jopp_parser_parse_data_memory_resource)
+{
+	std::pmr::monotonic_buffer_resource resource;
+	jopp::container val;
+	{
+		default_resource_override no_default{std::pmr::null_memory_resource()};
+		jopp::parser parser{val, 1024, &resource};
+		EXPECT_EQ(parser.resource(), &resource);
+
+		auto res = parser.parse(
+			std::span{std::data(json_test_data), std::size(json_test_data)});
+		EXPECT_EQ(res.ec, jopp::parser_error_code::completed);
+	}
+
+	auto const& root = *val.get_if<jopp::object>();
+	EXPECT_EQ(root.get_allocator().resource(), &resource);
+	EXPECT_EQ(std::size(root), 10);
+	auto const& obj = *root.find("had")->second.get_if<jopp::object>();
+	EXPECT_EQ(obj.get_allocator().resource(), &resource);
+	auto const& array = *obj.find("tightly")->second.get_if<jopp::array>();
+	EXPECT_EQ(array.get_allocator().resource(), &resource);
+	EXPECT_EQ(array[1], jopp::value{"feet"});
+	EXPECT_EQ(array[1].get_if<jopp::string>()->get_allocator().resource(), &resource);
+}
+
+TESTCASE(jopp_parser_nested_containers_in_growing_parent)
+{
+	std::string input{"["};
+	for(size_t k = 0; k != 100; ++k)
+	{
+		auto const num = std::to_string(k);
+		input.append(k == 0 ? "[" : ",[").append(num).append(", {\"a\": [").append(num).append("]}]");
+	}
+	input.append("]");
+
+	jopp::container val;
+	jopp::parser parser{val};
+	auto res = parser.parse(std::span{std::data(input), std::size(input)});
+	EXPECT_EQ(res.ec, jopp::parser_error_code::completed);
+
+	auto const& root = *val.get_if<jopp::array>();
+	EXPECT_EQ(std::size(root), 100);
+	for(size_t k = 0; k != std::size(root); ++k)
+	{
+		auto const& item = *root[k].get_if<jopp::array>();
+		EXPECT_EQ(std::size(item), 2);
+		EXPECT_EQ(item[0], jopp::value{static_cast<jopp::number>(k)});
+		auto const& inner = *item[1].get_if<jopp::object>()->find("a")->second.get_if<jopp::array>();
+		EXPECT_EQ(inner[0], jopp::value{static_cast<jopp::number>(k)});
+	}
+}
+
+TESTCASE(jopp_parser_reset)
+{
+	jopp::container first;
+	jopp::parser parser{first};
+	{
+		std::string_view input{"{\"foo\": [1, 2,"};
+		auto const res = parser.parse(input);
+		EXPECT_EQ(res.ec, jopp::parser_error_code::more_data_needed);
+		EXPECT_EQ(parser.current_depth(), 2);
+	}
+
+	jopp::container second;
+	parser.reset(second);
+	EXPECT_EQ(parser.current_depth(), 0);
+	{
+		std::string_view input{"\n[true, {\"bar\": null}]"};
+		auto const res = parser.parse(input);
+		EXPECT_EQ(res.ec, jopp::parser_error_code::completed);
+		EXPECT_EQ(res.line, 2);
+		EXPECT_EQ(res.col, 21);
+	}
+	EXPECT_EQ(&parser.root(), &second);
+	EXPECT_EQ(std::size(*second.get_if<jopp::array>()), 2);
+	EXPECT_EQ(std::size(*first.get_if<jopp::object>()), 0);
+
+	jopp::container third;
+	parser.reset(third);
+	{
+		std::string_view input{"{\"a\": 1, \"a\": 2}"};
+		auto const res = parser.parse(input);
+		EXPECT_EQ(res.ec, jopp::parser_error_code::key_already_exists);
+	}
+
+	parser.reset(third);
+	{
+		std::string_view input{"{\"a\": 1, \"b\": 2}"};
+		auto const res = parser.parse(input);
+		EXPECT_EQ(res.ec, jopp::parser_error_code::completed);
+	}
+	EXPECT_EQ(std::size(*third.get_if<jopp::object>()), 2);
+}
+
+TESTCASE(jopp_parser_unchecked_policy)
+{
+	{
+		jopp::container root;
+		jopp::basic_parser<jopp::unchecked_parser_policy> parser{root, 2};
+		std::string_view input{"{\"a\": [[[1]]],\n\"b\": {\"c\": [true, null]}, \"d\": \"text\"}"};
+		auto const res = parser.parse(input);
+		EXPECT_EQ(res.ec, jopp::parser_error_code::completed);
+		EXPECT_EQ(res.ptr, std::end(input));
+		EXPECT_EQ(res.line, 0);
+		EXPECT_EQ(res.col, 0);
+
+		auto const& obj = root.get<jopp::object>();
+		EXPECT_EQ(obj.get_field_as<jopp::string>("d"), "text");
+		EXPECT_EQ(std::size(obj.get_field_as<jopp::object>("b").get_field_as<jopp::array>("c")), 2);
+	}
+
+	{
+		jopp::container root;
+		jopp::basic_parser<jopp::unchecked_parser_policy> parser{root};
+		std::string_view input{"{\"a\": 1, \"a\": {\"b\": 2}, \"c\": 3}"};
+		auto const res = parser.parse(input);
+		EXPECT_EQ(res.ec, jopp::parser_error_code::completed);
+		auto const& obj = root.get<jopp::object>();
+		EXPECT_EQ(obj.contains("a"), true);
+		EXPECT_EQ(obj.get_field_as<jopp::number>("c"), 3.0);
+	}
+
+	{
+		jopp::container root;
+		jopp::basic_parser<jopp::unchecked_parser_policy> parser{root};
+		std::string_view input{"{\"a\": 1,\n \"b\": x}"};
+		auto const res = parser.parse(input);
+		EXPECT_EQ(res.ec, jopp::parser_error_code::invalid_value);
+		auto const pos = jopp::get_text_position(std::data(input), std::to_address(res.ptr) - 1);
+		EXPECT_EQ(pos.line, 2);
+		EXPECT_EQ(pos.col, 8);
+	}
+}
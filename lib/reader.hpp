@@ -0,0 +1,146 @@
+#ifndef JOPP_READER_HPP
+#define JOPP_READER_HPP
+
+#include "./parser.hpp"
+
+#include <utility>
+
+namespace jopp::inline JOPP_OBJECT_STORAGE_NAMESPACE
+{
+	enum class token_kind
+	{
+		none,
+		begin_object,
+		end_object,
+		begin_array,
+		end_array,
+		key,
+		string,
+		number,
+		boolean,
+		null
+	};
+
+	inline constexpr char const* to_string(token_kind kind)
+	{
+		switch(kind)
+		{
+			case token_kind::none:
+				return "none";
+			case token_kind::begin_object:
+				return "begin object";
+			case token_kind::end_object:
+				return "end object";
+			case token_kind::begin_array:
+				return "begin array";
+			case token_kind::end_array:
+				return "end array";
+			case token_kind::key:
+				return "key";
+			case token_kind::string:
+				return "string";
+			case token_kind::number:
+				return "number";
+			case token_kind::boolean:
+				return "boolean";
+			case token_kind::null:
+				return "null";
+		}
+		__builtin_unreachable();
+	}
+
+	struct token
+	{
+		token_kind kind{token_kind::none};
+		std::string_view value;
+		number number_value{};
+		size_t depth{};
+	};
+
+	template<class InputSeqIterator>
+	struct read_result
+	{
+		InputSeqIterator ptr;
+		parser_error_code ec;
+		size_t line;
+		size_t col;
+		struct token token;
+	};
+
+	class token_collector
+	{
+	public:
+		void on_begin_object()
+		{ set_token(token_kind::begin_object, m_depth++); }
+
+		void on_end_object()
+		{ set_token(token_kind::end_object, --m_depth); }
+
+		void on_begin_array()
+		{ set_token(token_kind::begin_array, m_depth++); }
+
+		void on_end_array()
+		{ set_token(token_kind::end_array, --m_depth); }
+
+		void on_key(std::string_view key)
+		{
+			m_buffer = key;
+			set_token(token_kind::key, m_depth, m_buffer);
+		}
+
+		void on_string(std::string_view val)
+		{
+			m_buffer = val;
+			set_token(token_kind::string, m_depth, m_buffer);
+		}
+
+		void on_number(number val)
+		{
+			set_token(token_kind::number, m_depth);
+			m_token.number_value = val;
+		}
+
+		void on_boolean(boolean val)
+		{ set_token(token_kind::boolean, m_depth, to_string(val)); }
+
+		void on_null()
+		{ set_token(token_kind::null, m_depth, to_string(null{})); }
+
+		bool pause_requested() const
+		{ return m_token.kind != token_kind::none; }
+
+		token take_token()
+		{ return std::exchange(m_token, token{}); }
+
+	private:
+		void set_token(token_kind kind, size_t depth, std::string_view value = std::string_view{})
+		{ m_token = token{kind, value, number{}, depth}; }
+
+		size_t m_depth{};
+		std::string m_buffer;
+		token m_token;
+	};
+
+	class reader
+	{
+	public:
+		explicit reader(std::optional<size_t> max_levels = 1024):
+			m_impl{max_levels}
+		{}
+
+		template<parser_input_range InputSeq>
+		auto next(InputSeq input_seq)
+		{
+			auto const res = m_impl.parse(input_seq);
+			return read_result{res.ptr, res.ec, res.line, res.col, m_impl.handler().take_token()};
+		}
+
+		auto current_depth() const
+		{ return m_impl.current_depth(); }
+
+	private:
+		event_parser<token_collector> m_impl;
+	};
+}
+
+#endif
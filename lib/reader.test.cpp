@@ -0,0 +1,133 @@
+//@	{"target":{"name":"reader.test"}}
+
+#include "./reader.hpp"
+
+#include <testfwk/testfwk.hpp>
+
+#include <vector>
+
+namespace
+{
+	struct token_record
+	{
+		jopp::token_kind kind;
+		std::string value;
+		jopp::number number_value;
+		size_t depth;
+
+		bool operator==(token_record const&) const = default;
+	};
+
+	std::vector<token_record> read_all(std::string_view data, size_t block_size, jopp::parser_error_code& ec)
+	{
+		std::vector<token_record> ret;
+		jopp::reader reader;
+		auto ptr = std::begin(data);
+		auto block_end = ptr;
+		while(true)
+		{
+			if(ptr == block_end)
+			{ block_end = std::min(ptr + block_size, std::end(data)); }
+
+			auto const res = reader.next(std::string_view{ptr, block_end});
+			if(res.token.kind != jopp::token_kind::none)
+			{
+				ret.push_back(token_record{
+					res.token.kind,
+					std::string{res.token.value},
+					res.token.number_value,
+					res.token.depth
+				});
+			}
+
+			ptr = res.ptr;
+			if(res.ec != jopp::parser_error_code::more_data_needed || ptr == std::end(data))
+			{
+				ec = res.ec;
+				return ret;
+			}
+		}
+	}
+}
+
+TESTCASE(jopp_token_kind_to_string)
+{
+	EXPECT_EQ(to_string(jopp::token_kind::none), std::string_view{"none"});
+	EXPECT_EQ(to_string(jopp::token_kind::begin_object), std::string_view{"begin object"});
+	EXPECT_EQ(to_string(jopp::token_kind::end_object), std::string_view{"end object"});
+	EXPECT_EQ(to_string(jopp::token_kind::begin_array), std::string_view{"begin array"});
+	EXPECT_EQ(to_string(jopp::token_kind::end_array), std::string_view{"end array"});
+	EXPECT_EQ(to_string(jopp::token_kind::key), std::string_view{"key"});
+	EXPECT_EQ(to_string(jopp::token_kind::string), std::string_view{"string"});
+	EXPECT_EQ(to_string(jopp::token_kind::number), std::string_view{"number"});
+	EXPECT_EQ(to_string(jopp::token_kind::boolean), std::string_view{"boolean"});
+	EXPECT_EQ(to_string(jopp::token_kind::null), std::string_view{"null"});
+}
+
+TESTCASE(jopp_reader_read_tokens)
+{
+	std::string_view data{R"({"key": [1.5, "a \"string\"", true, null, {}], "other key": false} trailing data)"};
+	std::vector<token_record> const expected{
+		{jopp::token_kind::begin_object, "", 0.0, 0},
+		{jopp::token_kind::key, "key", 0.0, 1},
+		{jopp::token_kind::begin_array, "", 0.0, 1},
+		{jopp::token_kind::number, "", 1.5, 2},
+		{jopp::token_kind::string, "a \"string\"", 0.0, 2},
+		{jopp::token_kind::boolean, "true", 0.0, 2},
+		{jopp::token_kind::null, "null", 0.0, 2},
+		{jopp::token_kind::begin_object, "", 0.0, 2},
+		{jopp::token_kind::end_object, "", 0.0, 2},
+		{jopp::token_kind::end_array, "", 0.0, 1},
+		{jopp::token_kind::key, "other key", 0.0, 1},
+		{jopp::token_kind::boolean, "false", 0.0, 1},
+		{jopp::token_kind::end_object, "", 0.0, 0}
+	};
+
+	for(size_t block_size = 1; block_size != std::size(data); ++block_size)
+	{
+		auto ec = jopp::parser_error_code::more_data_needed;
+		auto const tokens = read_all(data, block_size, ec);
+		EXPECT_EQ(ec, jopp::parser_error_code::completed);
+		EXPECT_EQ(tokens, expected);
+	}
+}
+
+TESTCASE(jopp_reader_position_after_token)
+{
+	std::string_view data{"[12,\n\"ab\"]"};
+	jopp::reader reader;
+
+	auto res = reader.next(data);
+	EXPECT_EQ(res.ec, jopp::parser_error_code::more_data_needed);
+	EXPECT_EQ(res.token.kind, jopp::token_kind::begin_array);
+	EXPECT_EQ(res.ptr, std::data(data) + 1);
+	EXPECT_EQ(res.col, 2);
+
+	res = reader.next(std::string_view{res.ptr, std::end(data)});
+	EXPECT_EQ(res.ec, jopp::parser_error_code::more_data_needed);
+	EXPECT_EQ(res.token.kind, jopp::token_kind::number);
+	EXPECT_EQ(res.token.number_value, 12.0);
+	EXPECT_EQ(*res.ptr, ',');
+
+	res = reader.next(std::string_view{res.ptr, std::end(data)});
+	EXPECT_EQ(res.ec, jopp::parser_error_code::more_data_needed);
+	EXPECT_EQ(res.token.kind, jopp::token_kind::string);
+	EXPECT_EQ(res.token.value, "ab");
+	EXPECT_EQ(res.line, 2);
+	EXPECT_EQ(res.col, 5);
+	EXPECT_EQ(reader.current_depth(), 1);
+
+	res = reader.next(std::string_view{res.ptr, std::end(data)});
+	EXPECT_EQ(res.ec, jopp::parser_error_code::completed);
+	EXPECT_EQ(res.token.kind, jopp::token_kind::end_array);
+	EXPECT_EQ(res.ptr, std::end(data));
+}
+
+TESTCASE(jopp_reader_error)
+{
+	auto ec = jopp::parser_error_code::more_data_needed;
+	auto const tokens = read_all(R"({"key": [1, foo]})", 4, ec);
+	EXPECT_EQ(ec, jopp::parser_error_code::invalid_value);
+	REQUIRE_EQ(std::size(tokens), 4);
+	EXPECT_EQ(tokens.back().kind, jopp::token_kind::number);
+}
@@ -7,12 +7,18 @@
 
 #include <string_view>
 #include <stack>
+#include <vector>
 #include <span>
 #include <functional>
 #include <algorithm>
 #include <ranges>
+#include <array>
+#include <charconv>
+#include <optional>
+#include <string>
+#include <stdexcept>
 
-namespace jopp
+namespace jopp::inline JOPP_OBJECT_STORAGE_NAMESPACE
 {
 	enum class serializer_error_code
 	{
@@ -28,9 +34,13 @@ namespace jopp
 	};
 
 
+	using serializer_range = static_range_processor<item_pointer,
+		decltype(std::begin(std::declval<object const&>())),
+		decltype(std::begin(std::declval<array const&>()))>;
+
 	struct serializer_context
 	{
-		range_processor<item_pointer> range;
+		serializer_range range;
 		char block_starter;
 		char block_terminator;
 		bool first_item{true};
@@ -59,7 +69,7 @@ namespace jopp
 	inline auto make_serializer_context(std::reference_wrapper<object const> val)
 	{
 		return serializer_context{
-			.range = range_processor<item_pointer>{std::begin(val.get()), std::end(val.get())},
+			.range = serializer_range{std::begin(val.get()), std::end(val.get())},
 			.block_starter = delimiters::begin_object,
 			.block_terminator = delimiters::end_object
 		};
@@ -68,7 +78,7 @@ namespace jopp
 	inline auto make_serializer_context(std::reference_wrapper<array const> val)
 	{
 		return serializer_context{
-			.range = range_processor<item_pointer>{std::begin(val.get()), std::end(val.get())},
+			.range = serializer_range{std::begin(val.get()), std::end(val.get())},
 			.block_starter = delimiters::begin_array,
 			.block_terminator = delimiters::end_array
 		};
@@ -83,174 +93,424 @@ namespace jopp
 	{
 	public:
 		explicit serializer(std::reference_wrapper<container const> root, bool pretty_print = false):
-			m_string_to_write{std::make_unique<std::string>()},
+			m_ptr{nullptr},
+			m_end{nullptr},
+			m_contexts{make_context_stack()},
+			m_state{state::begin_container},
+			m_current_item{nullptr},
+			m_indent{0},
+			m_spill{},
 			m_pretty_print{pretty_print}
-		{
-			m_contexts.push(make_serializer_context(root));
-			(*m_string_to_write) += m_contexts.top().block_starter;
-			if(pretty_print)
-			{ (*m_string_to_write) += '\n'; }
-			m_range_to_write = std::span{std::begin((*m_string_to_write)), std::end((*m_string_to_write))};
-		}
+		{ m_contexts.push(make_serializer_context(root)); }
 
 		explicit serializer(std::reference_wrapper<object const> root, bool pretty_print = false):
-			m_string_to_write{std::make_unique<std::string>()},
+			m_ptr{nullptr},
+			m_end{nullptr},
+			m_contexts{make_context_stack()},
+			m_state{state::begin_container},
+			m_current_item{nullptr},
+			m_indent{0},
+			m_spill{},
 			m_pretty_print{pretty_print}
-		{
-			m_contexts.push(make_serializer_context(root));
-			(*m_string_to_write) += m_contexts.top().block_starter;
-			if(pretty_print)
-			(*m_string_to_write) += '\n';
-			m_range_to_write = std::span{std::begin((*m_string_to_write)), std::end((*m_string_to_write))};
-		}
+		{ m_contexts.push(make_serializer_context(root)); }
 
 		explicit serializer(std::reference_wrapper<array const> root, bool pretty_print = false):
-			m_string_to_write{std::make_unique<std::string>()},
+			m_ptr{nullptr},
+			m_end{nullptr},
+			m_contexts{make_context_stack()},
+			m_state{state::begin_container},
+			m_current_item{nullptr},
+			m_indent{0},
+			m_spill{},
 			m_pretty_print{pretty_print}
-		{
-			m_contexts.push(make_serializer_context(root));
-			(*m_string_to_write) += m_contexts.top().block_starter;
-			if(pretty_print)
-			{ (*m_string_to_write) += '\n'; }
-			m_range_to_write = std::span{std::begin((*m_string_to_write)), std::end((*m_string_to_write))};
-		}
+		{ m_contexts.push(make_serializer_context(root)); }
 
+		// Writes as much as fits into output_buffer. On illegal_char_in_string, ptr is at the start
+		// of the item that could not be written, unless part of it was written by an earlier call.
 		serialize_result serialize(std::span<char> output_buffer);
 
 	private:
-		std::unique_ptr<std::string> m_string_to_write;
-		std::span<char const> m_range_to_write;
-		std::stack<serializer_context> m_contexts;
+		// Each step writes one token. A step that does not fit sets the state to the next step
+		// before returning, so that serialization can resume from there.
+		enum class state
+		{
+			begin_container,
+			next_item,
+			indent,
+			begin_key,
+			key,
+			end_key,
+			value,
+			string_value,
+			end_string_value,
+			end_container,
+			end_container_indent,
+			end_container_terminator
+		};
+
+		enum class write_status
+		{
+			completed,
+			buffer_is_full,
+			illegal_char_in_string
+		};
+
+		// Writes as much of token as fits, and stores the rest in the spill area
+		bool put(std::string_view token);
+
+		bool put_indent();
+
+		write_status put_escaped();
+
+		char* m_ptr;
+		char* m_end;
+		// Contexts are stored in a vector with room for typical nesting depths, so that entering a
+		// container does not allocate
+		using context_stack = std::stack<serializer_context, std::vector<serializer_context>>;
+
+		static context_stack make_context_stack()
+		{
+			std::vector<serializer_context> ret;
+			ret.reserve(64);
+			return context_stack{std::move(ret)};
+		}
+
+		context_stack m_contexts;
+		state m_state;
+		item_pointer m_current_item;
+		std::string_view m_string;
+		size_t m_indent;
+		std::array<char, 32> m_spill;
+		std::string_view m_spilled;
 		bool m_pretty_print;
 	};
 }
 
+inline bool jopp::serializer::put(std::string_view token)
+{
+	auto const n = std::min(std::size(token), static_cast<size_t>(m_end - m_ptr));
+	m_ptr = std::copy_n(std::data(token), n, m_ptr);
+	if(n == std::size(token))
+	{ return true; }
+
+	auto const spill_end = std::copy(std::begin(token) + n, std::end(token), std::data(m_spill));
+	m_spilled = std::string_view{std::data(m_spill), spill_end};
+	return false;
+}
+
+inline bool jopp::serializer::put_indent()
+{
+	auto const n = std::min(m_indent, static_cast<size_t>(m_end - m_ptr));
+	m_ptr = std::fill_n(m_ptr, n, '\t');
+	m_indent -= n;
+	return m_indent == 0;
+}
+
+inline jopp::serializer::write_status jopp::serializer::put_escaped()
+{
+	auto const res = escape(m_string, std::span{m_ptr, m_end});
+	m_string.remove_prefix(static_cast<size_t>(res.in - std::data(m_string)));
+	m_ptr = res.out;
+	switch(res.status)
+	{
+		case escape_status::completed:
+			return write_status::completed;
+
+		case escape_status::illegal_char:
+			return write_status::illegal_char_in_string;
+
+		case escape_status::buffer_is_full:
+			break;
+	}
+
+	// An escape sequence that does not fit is split through the spill area
+	if(m_ptr != m_end)
+	{
+		std::array const token{begin_esc_seq, *get_escape_char(m_string.front())};
+		m_string.remove_prefix(1);
+		put(std::string_view{std::data(token), std::size(token)});
+	}
+	return write_status::buffer_is_full;
+}
+
 inline jopp::serialize_result jopp::serializer::serialize(std::span<char> output_buffer)
 {
+	m_ptr = std::data(output_buffer);
+	m_end = m_ptr + std::size(output_buffer);
+	auto const buffer_is_full = [this]() {
+		return serialize_result{m_ptr, serializer_error_code::buffer_is_full};
+	};
+
+	if(!m_spilled.empty())
+	{
+		auto const n = std::min(std::size(m_spilled), static_cast<size_t>(m_end - m_ptr));
+		m_ptr = std::copy_n(std::data(m_spilled), n, m_ptr);
+		m_spilled.remove_prefix(n);
+		if(!m_spilled.empty())
+		{ return buffer_is_full(); }
+	}
+
+	auto item_begin = m_ptr;
 	auto const pretty_print = m_pretty_print;
 	while(true)
 	{
-		if(std::begin(output_buffer) == std::end(output_buffer))
-		{ return serialize_result{std::data(output_buffer), serializer_error_code::buffer_is_full}; }
-
-		auto res = write_buffer(m_range_to_write, output_buffer);
-		m_range_to_write = res.in;
-		output_buffer = res.out;
-		if(m_contexts.empty())
-		{ return serialize_result{std::data(output_buffer), serializer_error_code::completed}; }
-
-		if(std::size(m_range_to_write) == 0)
+		switch(m_state)
 		{
-			(*m_string_to_write).clear();
-			auto& current_context = m_contexts.top();
+			case state::begin_container:
+			{
+				m_state = state::next_item;
+				std::array const token{m_contexts.top().block_starter, '\n'};
+				if(!put(std::string_view{std::data(token), pretty_print ? 2u : 1u}))
+				{ return buffer_is_full(); }
+				break;
+			}
 
-			auto const res = current_context.range.pop_element();
-			if(!res.has_value())
+			case state::next_item:
 			{
-				if(pretty_print)
+				if(m_contexts.empty())
+				{ return serialize_result{m_ptr, serializer_error_code::completed}; }
+
+				item_begin = m_ptr;
+				auto& current_context = m_contexts.top();
+				m_current_item = current_context.range.pop_element();
+				if(!m_current_item.has_value())
 				{
-					(*m_string_to_write) += '\n';
-					for(size_t k = 0; k != m_contexts.size() - 1; ++k)
-					{ (*m_string_to_write) += '\t'; }
+					m_state = state::end_container;
+					break;
 				}
-				(*m_string_to_write) += std::string{current_context.block_terminator};
-				if(m_contexts.size() == 1)
-				{ (*m_string_to_write) += '\n'; }
-				m_range_to_write = std::span{std::begin((*m_string_to_write)), std::end((*m_string_to_write))};
-				m_contexts.pop();
-				continue;
+
+				m_state = state::indent;
+				m_indent = pretty_print ? m_contexts.size() : 0;
+				if(!std::exchange(current_context.first_item, false))
+				{
+					if(!put(pretty_print ? std::string_view{",\n"} : std::string_view{","}))
+					{ return buffer_is_full(); }
+				}
+				break;
 			}
 
-			if(!current_context.first_item)
+			case state::indent:
+				if(!put_indent())
+				{ return buffer_is_full(); }
+				m_state = m_contexts.top().block_starter == delimiters::begin_object ? state::begin_key : state::value;
+				break;
+
+			case state::begin_key:
+				m_string = m_current_item.get_key();
+				m_state = state::key;
+				if(!put(std::string_view{"\""}))
+				{ return buffer_is_full(); }
+				break;
+
+			case state::key:
+				switch(put_escaped())
+				{
+					case write_status::completed:
+						m_state = state::end_key;
+						break;
+					case write_status::buffer_is_full:
+						return buffer_is_full();
+					case write_status::illegal_char_in_string:
+						return serialize_result{item_begin, serializer_error_code::illegal_char_in_string};
+				}
+				break;
+
+			case state::end_key:
+				m_state = state::value;
+				if(!put(pretty_print ? std::string_view{"\": "} : std::string_view{"\":"}))
+				{ return buffer_is_full(); }
+				break;
+
+			case state::value:
 			{
-				(*m_string_to_write) += delimiters::value_separator;
-				if(pretty_print)
-				{ (*m_string_to_write) += '\n'; }
+				m_state = state::next_item;
+				auto const fits = m_current_item.get_value().visit(overload{
+					[this](number val) {
+						if(m_end - m_ptr >= static_cast<ptrdiff_t>(max_number_size))
+						{
+							m_ptr = write_number(m_ptr, val);
+							return true;
+						}
+						std::array<char, max_number_size> buffer;
+						return put(std::string_view{std::data(buffer), write_number(std::data(buffer), val)});
+					},
+					[this](auto const& val) {
+						return put(to_string(val));
+					},
+					[this](jopp::string const& val) {
+						m_string = val;
+						m_state = state::string_value;
+						return put(std::string_view{"\""});
+					},
+					[this](jopp::string_ref const& val) {
+						m_string = val.view();
+						m_state = state::string_value;
+						return put(std::string_view{"\""});
+					},
+					[this](jopp::object const& val) {
+						m_contexts.push(make_serializer_context(val));
+						m_state = state::begin_container;
+						return true;
+					},
+					[this](jopp::array const& val) {
+						m_contexts.push(make_serializer_context(val));
+						m_state = state::begin_container;
+						return true;
+					}
+				});
+				if(!fits)
+				{ return buffer_is_full(); }
+				break;
 			}
-			current_context.first_item = false;
-			if(pretty_print)
+
+			case state::string_value:
+				switch(put_escaped())
+				{
+					case write_status::completed:
+						m_state = state::end_string_value;
+						break;
+					case write_status::buffer_is_full:
+						return buffer_is_full();
+					case write_status::illegal_char_in_string:
+						return serialize_result{item_begin, serializer_error_code::illegal_char_in_string};
+				}
+				break;
+
+			case state::end_string_value:
+				m_state = state::next_item;
+				if(!put(std::string_view{"\""}))
+				{ return buffer_is_full(); }
+				break;
+
+			case state::end_container:
+				m_state = state::end_container_indent;
+				m_indent = pretty_print ? m_contexts.size() - 1 : 0;
+				if(pretty_print && !put(std::string_view{"\n"}))
+				{ return buffer_is_full(); }
+				break;
+
+			case state::end_container_indent:
+				if(!put_indent())
+				{ return buffer_is_full(); }
+				m_state = state::end_container_terminator;
+				break;
+
+			case state::end_container_terminator:
+			{
+				std::array const token{m_contexts.top().block_terminator, '\n'};
+				auto const is_root = m_contexts.size() == 1;
+				m_contexts.pop();
+				m_state = state::next_item;
+				if(!put(std::string_view{std::data(token), is_root ? 2u : 1u}))
+				{ return buffer_is_full(); }
+				break;
+			}
+		}
+	}
+}
+
+namespace jopp::inline JOPP_OBJECT_STORAGE_NAMESPACE
+{
+	// The exact number of chars that serializer writes for root, or nullopt if root contains a
+	// string that cannot be serialized. Nothing is written anywhere, except that numbers are
+	// formatted on the stack to find their length.
+	template<class T>
+ 	requires std::is_same_v<std::remove_cvref_t<T>, container>
+		|| std::is_same_v<std::remove_cvref_t<T>, array>
+		|| std::is_same_v<std::remove_cvref_t<T>, object>
+	inline std::optional<size_t> serialized_size(T const& root, bool pretty_print = false)
+	{
+		auto const newline = pretty_print ? size_t{1} : size_t{0};
+		std::vector<serializer_context> contexts;
+		contexts.reserve(64);
+		contexts.push_back(make_serializer_context(root));
+		size_t ret = 1 + newline;
+		while(!contexts.empty())
+		{
+			auto& current = contexts.back();
+			auto const depth = std::size(contexts);
+			auto const item = current.range.pop_element();
+			if(!item.has_value())
 			{
-				for(size_t k = 0; k != m_contexts.size(); ++k)
-				{ (*m_string_to_write) += '\t'; }
+				// Newline and indent, terminator, and a final newline after the root
+				ret += (pretty_print ? depth : 0) + 1 + (depth == 1 ? 1 : 0);
+				contexts.pop_back();
+				continue;
 			}
 
-			if(auto key = res.get_key(); key != std::string_view{})
+			if(!std::exchange(current.first_item, false))
+			{ ret += 1 + newline; }
+			ret += pretty_print ? depth : 0;
+
+			if(current.block_starter == delimiters::begin_object)
 			{
-				auto wrapped_string = wrap_string(key);
-				if(!wrapped_string.has_value())
-				{
-					return serialize_result{
-						std::data(output_buffer), serializer_error_code::illegal_char_in_string
-					};
-				}
-				(*m_string_to_write) += *wrapped_string;
-				(*m_string_to_write) += delimiters::name_separator;
-				if(pretty_print)
-				{ (*m_string_to_write) += ' '; }
+				auto const key_size = escaped_size(item.get_key());
+				if(!key_size.has_value())
+				{ return std::nullopt; }
+				ret += *key_size + 3 + newline;
 			}
 
-			auto const result = res.get_value().visit(overload{
-				[this](auto const& val) {
-					(*m_string_to_write) += to_string(val);
-					return true;
+			auto const value_size = item.get_value().visit(overload{
+				[](number val) -> std::optional<size_t> {
+					std::array<char, max_number_size> buffer;
+					return static_cast<size_t>(write_number(std::data(buffer), val) - std::data(buffer));
 				},
-				[this](jopp::string const& val){
-					auto str = wrap_string(val);
-					if(!str.has_value())
-					{ return false; }
-
-					(*m_string_to_write) += *str;
-					return true;
+				[](auto const& val) -> std::optional<size_t> {
+					return std::char_traits<char>::length(to_string(val));
 				},
-				[this, pretty_print](jopp::object const& val){
-					m_contexts.push(make_serializer_context(val));
-					(*m_string_to_write) += m_contexts.top().block_starter;
-					if(pretty_print)
-					{ (*m_string_to_write) += '\n'; }
-					return true;
+				[](jopp::string const& val) -> std::optional<size_t> {
+					auto const ret = escaped_size(val);
+					return ret.has_value() ? std::optional{*ret + 2} : std::nullopt;
 				},
-				[this, pretty_print](jopp::array const& val){
-					m_contexts.push(make_serializer_context(val));
-					(*m_string_to_write) += m_contexts.top().block_starter;
-					if(pretty_print)
-					{ (*m_string_to_write) += '\n'; }
-					return true;
+				[](jopp::string_ref const& val) -> std::optional<size_t> {
+					auto const ret = escaped_size(val.view());
+					return ret.has_value() ? std::optional{*ret + 2} : std::nullopt;
+				},
+				[&contexts, newline](jopp::object const& val) -> std::optional<size_t> {
+					contexts.push_back(make_serializer_context(val));
+					return 1 + newline;
+				},
+				[&contexts, newline](jopp::array const& val) -> std::optional<size_t> {
+					contexts.push_back(make_serializer_context(val));
+					return 1 + newline;
 				}
 			});
-			if(!result)
-			{
-				return serialize_result{
-					std::data(output_buffer), serializer_error_code::illegal_char_in_string
-				};
-			}
-
-			m_range_to_write = std::span{std::begin((*m_string_to_write)), std::end((*m_string_to_write))};
+			if(!value_size.has_value())
+			{ return std::nullopt; }
+			ret += *value_size;
 		}
+		return ret;
 	}
-}
 
-namespace jopp
-{
+	// Allocates the result once, with a size from serialized_size that the caller already has, for
+	// example for a Content-Length header. Throws std::length_error if the size is wrong.
 	template<class T>
  	requires std::is_same_v<std::remove_cvref_t<T>, container>
 		|| std::is_same_v<std::remove_cvref_t<T>, array>
 		|| std::is_same_v<std::remove_cvref_t<T>, object>
-	inline auto to_string(T const& root)
+	inline std::string to_string(T const& root, bool pretty_print, size_t expected_size)
 	{
-		std::string ret;
-		jopp::serializer serializer{root};
-		std::array<char, 65536> buffer{};
-		while(true)
-		{
-			auto const res = serializer.serialize(buffer);
-			ret.insert(std::end(ret), std::data(buffer), res.ptr);
+		std::string ret(expected_size, '\0');
+		jopp::serializer serializer{root, pretty_print};
+		auto const res = serializer.serialize(ret);
+		if(res.ec == jopp::serializer_error_code::illegal_char_in_string)
+		{ throw std::runtime_error{"jopp bad data"}; }
 
-			if(res.ec == jopp::serializer_error_code::completed)
-			{ return ret; }
+		if(res.ec != jopp::serializer_error_code::completed || res.ptr != std::data(ret) + std::size(ret))
+		{ throw std::length_error{"jopp serialized size does not match the expected size"}; }
+		return ret;
+	}
 
-			if(res.ec != jopp::serializer_error_code::buffer_is_full)
-			{ throw std::runtime_error{"jopp bad data"}; }
-		}
+	template<class T>
+ 	requires std::is_same_v<std::remove_cvref_t<T>, container>
+		|| std::is_same_v<std::remove_cvref_t<T>, array>
+		|| std::is_same_v<std::remove_cvref_t<T>, object>
+	inline auto to_string(T const& root)
+	{
+		auto const size = serialized_size(root);
+		if(!size.has_value())
+		{ throw std::runtime_error{"jopp bad data"}; }
+		return to_string(root, false, *size);
 	}
 
 	class json_buffer;
@@ -290,19 +550,11 @@ namespace jopp
 
 	inline std::string to_string(jopp::container const& root, bool pretty_print = false)
 	{
-		jopp::serializer serializer{root, pretty_print};
-		std::array<char, 4096> buffer{};
-		std::string ret;
-		while(true)
-		{
-			auto res = serializer.serialize(std::span{buffer});
-			if(res.ec == jopp::serializer_error_code::completed)
-			{ break; }
-			ret.append(std::begin(buffer), res.ptr);
-		}
-		return ret;
+		auto const size = serialized_size(root, pretty_print);
+		if(!size.has_value())
+		{ throw std::runtime_error{"jopp bad data"}; }
+		return to_string(root, pretty_print, *size);
 	}
-
 }
 
 #endif
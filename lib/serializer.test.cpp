@@ -369,4 +369,117 @@ TESTCASE(jopp_serializer_to_string)
 	std::string_view expected_result{R"({"a key with esc seq\n\t\\foo\"":"A value with esc seq\n\t\\foo\"","empty array":[],"empty object":{},"fireplace":720535269,"had":{"eaten":false,"independent":-1451031326,"long":-1437168945.8634152,"pull":1285774482.782745,"repeated end":{"value":46},"sound":false,"tightly":[[4,2,3,1],"feet",true,2145719840.4312375,-286229488,true,true,{"object in array":"bar"},{"object with literal last":null}]},"it":false,"refused":"better","testing null":null,"without":true,"wood":"involved"}
 )"};
 	EXPECT_EQ(res, expected_result);
-}
\ No newline at end of file
+}
+
+TESTCASE(jopp_serializer_tiny_buffers)
+{
+	jopp::object inner;
+	inner.insert("", std::string(100, 'x') + "\t\"\n");
+	inner.insert("number", 1.0/3.0);
+	jopp::array deep;
+	deep.push_back(std::move(inner));
+	jopp::object root;
+	root.insert("key\\with\\escapes", std::move(deep));
+	jopp::container const container{std::move(root)};
+
+	for(auto pretty_print : {false, true})
+	{
+		auto const expected = jopp::to_string(container, pretty_print);
+		EXPECT_EQ(expected.back(), '\n');
+		for(size_t block_size : {1, 2, 3, 7})
+		{
+			jopp::serializer serializer{container, pretty_print};
+			std::string output;
+			std::array<char, 7> buffer{};
+			while(true)
+			{
+				auto const res = serializer.serialize(std::span{std::data(buffer), block_size});
+				output.append(std::data(buffer), res.ptr);
+				if(res.ec == jopp::serializer_error_code::completed)
+				{ break; }
+				REQUIRE_EQ(res.ec, jopp::serializer_error_code::buffer_is_full);
+			}
+			EXPECT_EQ(output, expected);
+		}
+	}
+
+	EXPECT_EQ(jopp::to_string(container, false),
+		"{\"key\\\\with\\\\escapes\":[{\"\":\"" + std::string(100, 'x') + "\\t\\\"\\n\",\"number\":0.3333333333333333}]}\n");
+}
+
+TESTCASE(jopp_serializer_serialized_size)
+{
+	jopp::object inner;
+	inner.insert("escaped \"key\"", "A\tvalue");
+	inner.insert("empty object", jopp::object{});
+	inner.insert("empty array", jopp::array{});
+	inner.insert("number", -1.0e100);
+	inner.insert("null", jopp::null{});
+	jopp::array items;
+	items.push_back(std::move(inner));
+	items.push_back(true);
+	items.push_back(12345.0);
+	items.push_back(jopp::array{});
+	jopp::object root;
+	root.insert("items", std::move(items));
+	root.insert("", false);
+	jopp::container const container{std::move(root)};
+
+	for(auto pretty_print : {false, true})
+	{
+		jopp::serializer serializer{container, pretty_print};
+		std::string output;
+		std::array<char, 16> buffer{};
+		while(true)
+		{
+			auto const res = serializer.serialize(buffer);
+			output.append(std::data(buffer), res.ptr);
+			if(res.ec == jopp::serializer_error_code::completed)
+			{ break; }
+			REQUIRE_EQ(res.ec, jopp::serializer_error_code::buffer_is_full);
+		}
+		auto const size = jopp::serialized_size(container, pretty_print);
+		REQUIRE_EQ(size.value(), std::size(output));
+		EXPECT_EQ(jopp::to_string(container, pretty_print, *size), output);
+	}
+
+	EXPECT_EQ(jopp::serialized_size(jopp::array{}).value(), 3);
+	EXPECT_EQ(jopp::serialized_size(jopp::object{}, true).value(), 5);
+
+	jopp::object obj;
+	obj.insert("key", std::string{"a\0b", 3});
+	EXPECT_EQ(jopp::serialized_size(obj).has_value(), false);
+}
+
+TESTCASE(jopp_serializer_to_string_expected_size)
+{
+	jopp::object root;
+	root.insert("key", "value");
+	root.insert("list", jopp::array{});
+	std::string_view const expected{"{\"key\":\"value\",\"list\":[]}\n"};
+	EXPECT_EQ(jopp::to_string(root, false, std::size(expected)), expected);
+
+	for(auto const size : {std::size(expected) - 1, std::size(expected) + 1, size_t{0}})
+	{
+		try
+		{
+			(void)jopp::to_string(root, false, size);
+			EXPECT_EQ(true, false);
+		}
+		catch(std::length_error const&)
+		{}
+	}
+
+	jopp::container const container{std::move(root)};
+	EXPECT_EQ(jopp::to_string(container), expected);
+
+	jopp::object bad;
+	bad.insert("key", std::string{"a\0b", 3});
+	try
+	{
+		(void)jopp::to_string(jopp::container{std::move(bad)});
+		EXPECT_EQ(true, false);
+	}
+	catch(std::runtime_error const& err)
+	{ EXPECT_EQ(std::string_view{err.what()}, "jopp bad data"); }
+}
@@ -0,0 +1,115 @@
+#ifndef JOPP_SIMD_HPP
+#define JOPP_SIMD_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__PCLMUL__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace jopp::simd
+{
+	// Bit k in a mask returned by char_block refers to char k in the block
+	class char_block
+	{
+	public:
+		static constexpr size_t size = 64;
+
+		explicit char_block(char const* src)
+		{
+#if defined(__AVX2__)
+			m_data[0] = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src));
+			m_data[1] = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + 32));
+#elif defined(__SSE2__)
+			for(size_t k = 0; k != 4; ++k)
+			{ m_data[k] = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + 16*k)); }
+#else
+			memcpy(m_data, src, size);
+#endif
+		}
+
+		uint64_t eq(char ch) const
+		{
+#if defined(__AVX2__)
+			auto const val = _mm256_set1_epi8(ch);
+			return to_mask(_mm256_cmpeq_epi8(m_data[0], val), _mm256_cmpeq_epi8(m_data[1], val));
+#elif defined(__SSE2__)
+			auto const val = _mm_set1_epi8(ch);
+			return to_mask(_mm_cmpeq_epi8(m_data[0], val), _mm_cmpeq_epi8(m_data[1], val),
+				_mm_cmpeq_epi8(m_data[2], val), _mm_cmpeq_epi8(m_data[3], val));
+#else
+			uint64_t ret{};
+			for(size_t k = 0; k != size; ++k)
+			{ ret |= static_cast<uint64_t>(m_data[k] == ch) << k; }
+			return ret;
+#endif
+		}
+
+		uint64_t less_equal(unsigned char ch) const
+		{
+#if defined(__AVX2__)
+			auto const val = _mm256_set1_epi8(static_cast<char>(ch));
+			return to_mask(_mm256_cmpeq_epi8(_mm256_min_epu8(m_data[0], val), m_data[0]),
+				_mm256_cmpeq_epi8(_mm256_min_epu8(m_data[1], val), m_data[1]));
+#elif defined(__SSE2__)
+			auto const val = _mm_set1_epi8(static_cast<char>(ch));
+			return to_mask(_mm_cmpeq_epi8(_mm_min_epu8(m_data[0], val), m_data[0]),
+				_mm_cmpeq_epi8(_mm_min_epu8(m_data[1], val), m_data[1]),
+				_mm_cmpeq_epi8(_mm_min_epu8(m_data[2], val), m_data[2]),
+				_mm_cmpeq_epi8(_mm_min_epu8(m_data[3], val), m_data[3]));
+#else
+			uint64_t ret{};
+			for(size_t k = 0; k != size; ++k)
+			{ ret |= static_cast<uint64_t>(static_cast<unsigned char>(m_data[k]) <= ch) << k; }
+			return ret;
+#endif
+		}
+
+	private:
+#if defined(__AVX2__)
+		static uint64_t to_mask(__m256i lo, __m256i hi)
+		{
+			return static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(lo)))
+				| (static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(hi))) << 32);
+		}
+
+		__m256i m_data[2];
+#elif defined(__SSE2__)
+		static uint64_t to_mask(__m128i a, __m128i b, __m128i c, __m128i d)
+		{
+			return static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(a)))
+				| (static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(b))) << 16)
+				| (static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(c))) << 32)
+				| (static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(d))) << 48);
+		}
+
+		__m128i m_data[4];
+#else
+		char m_data[size];
+#endif
+	};
+
+	// Bit k of the result is the parity of bits 0 to k in x
+	inline uint64_t prefix_xor(uint64_t x)
+	{
+#if defined(__PCLMUL__)
+		auto const all_ones = _mm_set1_epi8('\xff');
+		auto const res = _mm_clmulepi64_si128(_mm_set_epi64x(0, static_cast<int64_t>(x)), all_ones, 0);
+		return static_cast<uint64_t>(_mm_cvtsi128_si64(res));
+#else
+		x ^= x << 1;
+		x ^= x << 2;
+		x ^= x << 4;
+		x ^= x << 8;
+		x ^= x << 16;
+		x ^= x << 32;
+		return x;
+#endif
+	}
+}
+
+#endif
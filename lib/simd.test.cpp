@@ -0,0 +1,49 @@
+//@	{"target":{"name":"simd.test"}}
+
+#include "./simd.hpp"
+
+#include <testfwk/testfwk.hpp>
+
+#include <array>
+
+TESTCASE(jopp_simd_char_block_eq)
+{
+	std::array<char, jopp::simd::char_block::size> data{};
+	data.fill('a');
+	data[0] = '"';
+	data[17] = '"';
+	data[40] = '"';
+	data[63] = '"';
+
+	jopp::simd::char_block const block{std::data(data)};
+	EXPECT_EQ(block.eq('"'), (1ull << 0) | (1ull << 17) | (1ull << 40) | (1ull << 63));
+	EXPECT_EQ(block.eq('a'), ~((1ull << 0) | (1ull << 17) | (1ull << 40) | (1ull << 63)));
+	EXPECT_EQ(block.eq('b'), 0);
+}
+
+TESTCASE(jopp_simd_char_block_less_equal)
+{
+	std::array<char, jopp::simd::char_block::size> data{};
+	for(size_t k = 0; k != std::size(data); ++k)
+	{ data[k] = static_cast<char>(4*k); }
+
+	jopp::simd::char_block const block{std::data(data)};
+	auto const mask = block.less_equal('\x1f');
+	for(size_t k = 0; k != std::size(data); ++k)
+	{ EXPECT_EQ(((mask >> k) & 1) != 0, static_cast<unsigned char>(data[k]) <= 0x1f); }
+}
+
+TESTCASE(jopp_simd_prefix_xor)
+{
+	for(uint64_t x : {0ull, 1ull, 0x8000000000000000ull, 0x0102040810204080ull, 0xdeadbeefcafebabeull})
+	{
+		uint64_t expected{};
+		bool parity = false;
+		for(size_t k = 0; k != 64; ++k)
+		{
+			parity ^= ((x >> k) & 1) != 0;
+			expected |= static_cast<uint64_t>(parity) << k;
+		}
+		EXPECT_EQ(jopp::simd::prefix_xor(x), expected);
+	}
+}
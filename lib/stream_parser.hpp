@@ -0,0 +1,118 @@
+#ifndef JOPP_STREAM_PARSER_HPP
+#define JOPP_STREAM_PARSER_HPP
+
+#include "./parser.hpp"
+
+#include <algorithm>
+#include <ranges>
+
+namespace jopp::inline JOPP_OBJECT_STORAGE_NAMESPACE
+{
+	// Parses a stream of concatenated documents, such as NDJSON. Every document that is completed
+	// is passed to a callback. A document may be split across any number of calls to parse.
+	class stream_parser
+	{
+	public:
+		explicit stream_parser(std::optional<size_t> max_levels = 1024,
+			std::pmr::memory_resource* resource = std::pmr::get_default_resource()):
+			m_parser{m_root, max_levels, resource},
+			m_line{1},
+			m_col{0},
+			m_document_count{0},
+			m_error_ends_line{false},
+			m_skip_line{false}
+		{}
+
+		stream_parser(stream_parser const&) = delete;
+		stream_parser& operator=(stream_parser const&) = delete;
+
+		// Calls on_document with a container&& for each document completed within input_seq.
+		// Returns more_data_needed when all input has been consumed. Positions count from the
+		// start of the stream. After an error, parsing cannot continue until skip_line has been
+		// called.
+		template<parser_input_range InputSeq, class Callback>
+		auto parse(InputSeq input_seq, Callback&& on_document);
+
+		// Discards the document that failed to parse. The next call to parse starts by skipping the
+		// rest of the line where the error occurred, so that the following lines of an NDJSON
+		// stream can be read. The next call should start at ptr of the failed result. Since JSON
+		// allows newlines within a document, a line that is cut short is only detected on a later
+		// line, and that line is lost as well.
+		void skip_line()
+		{
+			m_parser.reset(m_root);
+			m_skip_line = !m_error_ends_line;
+			if(m_error_ends_line)
+			{
+				++m_line;
+				m_col = 0;
+			}
+		}
+
+		// True if there is no partially parsed document
+		bool at_document_boundary() const
+		{ return m_parser.current_depth() == 0; }
+
+		size_t document_count() const
+		{ return m_document_count; }
+
+		std::pmr::memory_resource* resource() const
+		{ return m_parser.resource(); }
+
+	private:
+		container m_root;
+		parser m_parser;
+		size_t m_line;
+		size_t m_col;
+		size_t m_document_count;
+		bool m_error_ends_line;
+		bool m_skip_line;
+	};
+}
+
+template<jopp::parser_input_range InputSeq, class Callback>
+auto jopp::stream_parser::parse(InputSeq input_seq, Callback&& on_document)
+{
+	auto ptr = std::begin(input_seq);
+	auto const end = std::end(input_seq);
+	if(m_skip_line)
+	{
+		auto const line_end = std::find(ptr, end, '\n');
+		if(line_end == end)
+		{
+			m_col += static_cast<size_t>(std::distance(ptr, end));
+			return parse_result{end, parser_error_code::more_data_needed, m_line, m_col};
+		}
+
+		m_skip_line = false;
+		++m_line;
+		m_col = 0;
+		ptr = std::next(line_end);
+	}
+
+	while(true)
+	{
+		auto res = m_parser.parse(std::ranges::subrange{ptr, end});
+		res.col = res.line == 1 ? m_col + res.col : res.col;
+		res.line = m_line + res.line - 1;
+		if(res.ec == parser_error_code::more_data_needed)
+		{ return res; }
+
+		if(res.ec != parser_error_code::completed)
+		{
+			m_error_ends_line = *std::prev(res.ptr) == '\n';
+			m_line = res.line;
+			m_col = res.col;
+			return res;
+		}
+
+		++m_document_count;
+		on_document(std::move(m_root));
+		m_parser.reset(m_root);
+		m_line = res.line;
+		m_col = res.col;
+		ptr = res.ptr;
+	}
+}
+
+#endif
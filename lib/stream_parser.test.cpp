@@ -0,0 +1,168 @@
+//@	{"target":{"name":"stream_parser.test"}}
+
+#include "./stream_parser.hpp"
+
+#include <testfwk/testfwk.hpp>
+
+#include <vector>
+
+namespace
+{
+	constexpr std::string_view ndjson_test_data{
+		"{\"seq\": 0, \"tags\": [\"a\", \"b\"]}\n"
+		"{\"seq\": 1, \"tags\": []}\n"
+		"[1, 2, {\"seq\": 2}]\n"
+		"{\"seq\": 3, \"nested\": {\"value\": null}}\n"
+	};
+
+	void check_documents(std::vector<jopp::container> const& docs)
+	{
+		REQUIRE_EQ(std::size(docs), 4);
+		EXPECT_EQ(docs[0].get_if<jopp::object>()->get_field_as<jopp::number>("seq"), 0.0);
+		EXPECT_EQ(std::size(docs[0].get_if<jopp::object>()->get_field_as<jopp::array>("tags")), 2);
+		EXPECT_EQ(docs[1].get_if<jopp::object>()->get_field_as<jopp::number>("seq"), 1.0);
+		EXPECT_EQ(std::size(*docs[2].get_if<jopp::array>()), 3);
+		auto const& nested = docs[3].get_if<jopp::object>()->get_field_as<jopp::object>("nested");
+		EXPECT_EQ(nested.contains("value"), true);
+	}
+}
+
+TESTCASE(jopp_stream_parser_one_block)
+{
+	std::vector<jopp::container> docs;
+	jopp::stream_parser parser;
+	auto const res = parser.parse(ndjson_test_data, [&docs](jopp::container&& doc) {
+		docs.push_back(std::move(doc));
+	});
+	EXPECT_EQ(res.ec, jopp::parser_error_code::more_data_needed);
+	EXPECT_EQ(res.ptr, std::end(ndjson_test_data));
+	EXPECT_EQ(parser.at_document_boundary(), true);
+	EXPECT_EQ(parser.document_count(), 4);
+	check_documents(docs);
+}
+
+TESTCASE(jopp_stream_parser_any_block_size)
+{
+	for(size_t block_size = 1; block_size != 17; ++block_size)
+	{
+		std::vector<jopp::container> docs;
+		jopp::stream_parser parser;
+		auto input = ndjson_test_data;
+		while(!input.empty())
+		{
+			auto const res = parser.parse(input.substr(0, block_size), [&docs](jopp::container&& doc) {
+				docs.push_back(std::move(doc));
+			});
+			EXPECT_EQ(res.ec, jopp::parser_error_code::more_data_needed);
+			input.remove_prefix(std::min(block_size, std::size(input)));
+		}
+		EXPECT_EQ(parser.at_document_boundary(), true);
+		check_documents(docs);
+	}
+}
+
+TESTCASE(jopp_stream_parser_concatenated_documents)
+{
+	size_t count = 0;
+	jopp::stream_parser parser;
+	std::string_view input{"{}[]{\"a\":1}  [null]"};
+	auto const res = parser.parse(input, [&count](jopp::container&&) { ++count; });
+	EXPECT_EQ(res.ec, jopp::parser_error_code::more_data_needed);
+	EXPECT_EQ(count, 4);
+}
+
+TESTCASE(jopp_stream_parser_partial_document)
+{
+	size_t count = 0;
+	jopp::stream_parser parser;
+	std::string_view input{"{\"a\": 1}\n{\"b\": "};
+	auto const res = parser.parse(input, [&count](jopp::container&&) { ++count; });
+	EXPECT_EQ(res.ec, jopp::parser_error_code::more_data_needed);
+	EXPECT_EQ(count, 1);
+	EXPECT_EQ(parser.at_document_boundary(), false);
+}
+
+TESTCASE(jopp_stream_parser_error_position)
+{
+	jopp::stream_parser parser;
+	std::string_view input{"{\"a\": 1}\n{\"b\": 2}\n[1, x]\n"};
+	auto const res = parser.parse(input, [](jopp::container&&) {});
+	EXPECT_EQ(res.ec, jopp::parser_error_code::invalid_value);
+	EXPECT_EQ(res.line, 3);
+	EXPECT_EQ(res.col, 6);
+	EXPECT_EQ(parser.document_count(), 2);
+}
+
+TESTCASE(jopp_stream_parser_error_position_same_line)
+{
+	jopp::stream_parser parser;
+	std::string_view input{"[1] [x]"};
+	auto const res = parser.parse(input, [](jopp::container&&) {});
+	EXPECT_EQ(res.ec, jopp::parser_error_code::invalid_value);
+	EXPECT_EQ(res.line, 1);
+	EXPECT_EQ(res.col, 7);
+}
+
+TESTCASE(jopp_stream_parser_skip_line)
+{
+	std::vector<jopp::container> docs;
+	jopp::stream_parser parser;
+	std::string_view input{"{\"a\": 1}\n[1, x, 2]\n{\"b\": \"\n\"}\n[3]\n{\"c\": 3} x\n[5]\n"};
+	auto const on_document = [&docs](jopp::container&& doc) { docs.push_back(std::move(doc)); };
+
+	auto res = parser.parse(input, on_document);
+	EXPECT_EQ(res.ec, jopp::parser_error_code::invalid_value);
+	EXPECT_EQ(res.line, 2);
+	parser.skip_line();
+
+	res = parser.parse(std::string_view{res.ptr, std::end(input)}, on_document);
+	EXPECT_EQ(res.ec, jopp::parser_error_code::character_must_be_escaped);
+	EXPECT_EQ(res.line, 3);
+	parser.skip_line();
+
+	// The error was at the newline, so the next line is not skipped
+	res = parser.parse(std::string_view{res.ptr, std::end(input)}, on_document);
+	EXPECT_EQ(res.ec, jopp::parser_error_code::no_top_level_node);
+	EXPECT_EQ(res.line, 4);
+	parser.skip_line();
+
+	res = parser.parse(std::string_view{res.ptr, std::end(input)}, on_document);
+	EXPECT_EQ(res.ec, jopp::parser_error_code::no_top_level_node);
+	EXPECT_EQ(res.line, 6);
+	EXPECT_EQ(res.col, 10);
+	parser.skip_line();
+
+	res = parser.parse(std::string_view{res.ptr, std::end(input)}, on_document);
+	EXPECT_EQ(res.ec, jopp::parser_error_code::more_data_needed);
+	EXPECT_EQ(res.ptr, std::end(input));
+
+	REQUIRE_EQ(std::size(docs), 4);
+	EXPECT_EQ(docs[0].get_if<jopp::object>()->get_field_as<jopp::number>("a"), 1.0);
+	EXPECT_EQ(std::size(*docs[1].get_if<jopp::array>()), 1);
+	EXPECT_EQ(docs[2].get_if<jopp::object>()->get_field_as<jopp::number>("c"), 3.0);
+	EXPECT_EQ(std::size(*docs[3].get_if<jopp::array>()), 1);
+}
+
+TESTCASE(jopp_stream_parser_skip_line_across_blocks)
+{
+	size_t count = 0;
+	jopp::stream_parser parser;
+	auto const on_document = [&count](jopp::container&&) { ++count; };
+
+	std::string_view first{"[x, "};
+	auto res = parser.parse(first, on_document);
+	EXPECT_EQ(res.ec, jopp::parser_error_code::invalid_value);
+	parser.skip_line();
+
+	res = parser.parse(std::string_view{res.ptr, std::end(first)}, on_document);
+	EXPECT_EQ(res.ec, jopp::parser_error_code::more_data_needed);
+	res = parser.parse(std::string_view{"1, 2]"}, on_document);
+	EXPECT_EQ(res.ec, jopp::parser_error_code::more_data_needed);
+
+	std::string_view second{"3]\n[4]\n"};
+	res = parser.parse(second, on_document);
+	EXPECT_EQ(res.ec, jopp::parser_error_code::more_data_needed);
+	EXPECT_EQ(res.ptr, std::end(second));
+	EXPECT_EQ(count, 1);
+	EXPECT_EQ(parser.at_document_boundary(), true);
+}
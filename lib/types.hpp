@@ -2,6 +2,8 @@
 #define JOPP_JSON_TYPES_HPP
 
 #include "./utils.hpp"
+#include "./flat_map.hpp"
+#include "./hash_map.hpp"
 
 #include <variant>
 #include <map>
@@ -12,8 +14,25 @@
 #include <optional>
 #include <charconv>
 #include <array>
+#include <memory_resource>
+#include <cstdint>
+#include <cmath>
+#include <utility>
+#include <string_view>
+#include <cassert>
+
+// The choice of object storage changes the layout of object, and of everything that holds one.
+// Putting the types into an inline namespace named after the choice makes code built with
+// different choices refer to different symbols, rather than silently mixing them.
+#if defined(JOPP_FLAT_OBJECTS)
+#define JOPP_OBJECT_STORAGE_NAMESPACE flat_objects
+#elif defined(JOPP_HASHED_OBJECTS)
+#define JOPP_OBJECT_STORAGE_NAMESPACE hashed_objects
+#else
+#define JOPP_OBJECT_STORAGE_NAMESPACE ordered_objects
+#endif
 
-namespace jopp
+namespace jopp::inline JOPP_OBJECT_STORAGE_NAMESPACE
 {
 	template<class T>
 	struct get_type_name;
@@ -36,7 +55,45 @@ namespace jopp
 	class object;
 	class array;
 	using number = double;
-	using string = std::string;
+	using string = std::pmr::string;
+
+	// A string that is stored elsewhere, packed into one word. The address is stored in the low
+	// 48 bits, and the size in the high 16 bits.
+	class string_ref
+	{
+	public:
+		static constexpr size_t max_size = 0xffff;
+
+		static bool can_refer_to(std::string_view str)
+		{
+			return std::size(str) <= max_size
+				&& (reinterpret_cast<uintptr_t>(std::data(str)) >> address_bits) == 0;
+		}
+
+		explicit string_ref(std::string_view str):
+			m_value{static_cast<uint64_t>(reinterpret_cast<uintptr_t>(std::data(str)))
+				| (static_cast<uint64_t>(std::size(str)) << address_bits)}
+		{ assert(can_refer_to(str)); }
+
+		std::string_view view() const
+		{
+			return std::string_view{
+				reinterpret_cast<char const*>(static_cast<uintptr_t>(m_value & address_mask)),
+				static_cast<size_t>(m_value >> address_bits)
+			};
+		}
+
+		bool operator==(string_ref const& other) const
+		{ return view() == other.view(); }
+
+		bool operator!=(string_ref const& other) const
+		{ return !(*this == other); }
+
+	private:
+		static constexpr int address_bits = 48;
+		static constexpr uint64_t address_mask = (uint64_t{1} << address_bits) - 1;
+		uint64_t m_value;
+	};
 
 	template<>
 	struct get_type_name<object>
@@ -54,6 +111,10 @@ namespace jopp
 	struct get_type_name<string>
 	{ static constexpr char const* value = "string"; };
 
+	template<>
+	struct get_type_name<string_ref>
+	{ static constexpr char const* value = "string"; };
+
 	template<>
 	struct get_type_name<bool>
 	{ static constexpr char const* value = "boolean"; };
@@ -77,8 +138,87 @@ namespace jopp
 	inline decltype(auto) to_string(T&& val)
 	{ return std::forward<T>(val); }
 
+	// Handles numbers with at most 15 significant digits, and a power of ten that is exact in a
+	// double. The result is then correctly rounded, and equal to what std::from_chars returns.
+	// Anything else is left to std::from_chars.
+	inline std::optional<number> to_number_fast_path(std::string_view val)
+	{
+		constexpr std::array<double, 23> powers_of_ten{
+			1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+			1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+		};
+		constexpr int max_digits = 15;
+		auto const is_digit = [](char ch){ return ch >= '0' && ch <= '9'; };
+
+		auto ptr = std::begin(val);
+		auto const end = std::end(val);
+		auto const negative = ptr != end && *ptr == '-';
+		if(negative)
+		{ ++ptr; }
+
+		uint64_t mantissa{};
+		int digits{};
+		int exponent{};
+		auto const int_begin = ptr;
+		while(ptr != end && is_digit(*ptr))
+		{
+			mantissa = 10*mantissa + static_cast<uint64_t>(*ptr - '0');
+			digits += mantissa != 0 ? 1 : 0;
+			++ptr;
+		}
+		if(ptr == int_begin || digits > max_digits)
+		{ return std::nullopt; }
+
+		if(ptr != end && *ptr == '.')
+		{
+			++ptr;
+			auto const frac_begin = ptr;
+			while(ptr != end && is_digit(*ptr))
+			{
+				mantissa = 10*mantissa + static_cast<uint64_t>(*ptr - '0');
+				digits += mantissa != 0 ? 1 : 0;
+				--exponent;
+				++ptr;
+				if(digits > max_digits)
+				{ return std::nullopt; }
+			}
+			if(ptr == frac_begin)
+			{ return std::nullopt; }
+		}
+
+		if(ptr != end && (*ptr == 'e' || *ptr == 'E'))
+		{
+			++ptr;
+			auto const exp_negative = ptr != end && *ptr == '-';
+			if(ptr != end && (*ptr == '-' || *ptr == '+'))
+			{ ++ptr; }
+
+			auto const exp_begin = ptr;
+			int exp_val{};
+			while(ptr != end && is_digit(*ptr) && exp_val < 1000)
+			{
+				exp_val = 10*exp_val + (*ptr - '0');
+				++ptr;
+			}
+			if(ptr == exp_begin)
+			{ return std::nullopt; }
+			exponent += exp_negative ? -exp_val : exp_val;
+		}
+
+		if(ptr != end || exponent < -22 || exponent > 22)
+		{ return std::nullopt; }
+
+		auto ret = static_cast<double>(mantissa);
+		ret = exponent < 0 ? ret/powers_of_ten[static_cast<size_t>(-exponent)]
+			: ret*powers_of_ten[static_cast<size_t>(exponent)];
+		return negative ? -ret : ret;
+	}
+
 	inline std::optional<number> to_number(std::string_view val)
 	{
+		if(auto ret = to_number_fast_path(val); ret.has_value())
+		{ return ret; }
+
 		number ret{};
 		auto const res = std::from_chars(std::begin(val), std::end(val), ret);
 
@@ -92,17 +232,53 @@ namespace jopp
 		return ret;
 	}
 
+	// Enough room for any number written by write_number
+	inline constexpr size_t max_number_size = 32;
+
+	// Writes x to out, which must have room for max_number_size chars, and returns the end of the
+	// output. The output is the same as that of std::to_chars. Whole numbers below 2^53 take an
+	// integer path, which avoids the shortest round-trip search.
+	inline char* write_number(char* out, number x)
+	{
+		constexpr auto int_limit = static_cast<number>(int64_t{1} << 53);
+		if(x > -int_limit && x < int_limit)
+		{
+			auto const i = static_cast<int64_t>(x);
+			if(static_cast<number>(i) == x && (i != 0 || !std::signbit(x)))
+			{
+				auto const res = std::to_chars(out, out + max_number_size, i);
+
+				// std::to_chars switches to scientific notation when that is shorter, which requires
+				// at least five trailing zeros
+				auto const digits_begin = out + (i < 0 ? 1 : 0);
+				auto significant_end = res.ptr;
+				while(significant_end - digits_begin > 1 && *(significant_end - 1) == '0')
+				{ --significant_end; }
+				auto const zeros = res.ptr - significant_end;
+				if(zeros <= (significant_end - digits_begin > 1 ? 5 : 4))
+				{ return res.ptr; }
+			}
+		}
+		return std::to_chars(out, out + max_number_size, x).ptr;
+	}
+
 	inline std::string to_string(jopp::number x)
 	{
-		std::array<char, 32> buffer{};
-		auto const res = std::to_chars(std::begin(buffer), std::end(buffer), x);
-		return std::string{std::data(buffer), res.ptr};
+		std::array<char, max_number_size> buffer;
+		return std::string{std::data(buffer), write_number(std::data(buffer), x)};
 	}
 
 	template<class T>
 	inline constexpr auto is_object_or_array_v = is_same_without_cvref_v<T, array>
 		|| is_same_without_cvref_v<T, object>;
 
+	template<class T>
+	inline constexpr auto is_boxed_v = is_object_or_array_v<T> || is_same_without_cvref_v<T, string>;
+
+	template<class T>
+	inline constexpr auto is_string_like_v = !is_same_without_cvref_v<T, string>
+		&& std::is_convertible_v<T, std::string_view>;
+
 	template<class T>
 	concept dereferenceable = requires(T x)
 	{
@@ -116,30 +292,75 @@ namespace jopp
 		explicit field_type_mismatch_error(std::string_view key, std::type_identity<T>):
 			runtime_error{std::string{"Field `"}.append(key).append("` should be a ").append(get_type_name<T>::value)}
 		{}
+
+		// The value is a string, but it refers to the input, so it is not a jopp::string
+		static field_type_mismatch_error referenced_string(std::string_view key)
+		{
+			return field_type_mismatch_error{std::string{"Field `"}.append(key)
+				.append("` is a string that refers to the input. Read it as std::string_view.")};
+		}
+
+	private:
+		explicit field_type_mismatch_error(std::string const& msg):runtime_error{msg}
+		{}
 	};
 
+	template<class T>
+	struct boxed_deleter
+	{
+		void operator()(T* ptr) const
+		{
+			std::pmr::polymorphic_allocator<T> alloc{ptr->get_allocator().resource()};
+			std::destroy_at(ptr);
+			alloc.deallocate(ptr, 1);
+		}
+	};
+
+	template<class T>
+	using box = std::unique_ptr<T, boxed_deleter<T>>;
+
+	template<class T, class U = std::remove_cvref_t<T>>
+	box<U> make_box(T&& val)
+	{
+		std::pmr::polymorphic_allocator<U> alloc{val.get_allocator().resource()};
+		auto const ptr = alloc.allocate(1);
+		try
+		{ std::construct_at(ptr, std::forward<T>(val)); }
+		catch(...)
+		{
+			alloc.deallocate(ptr, 1);
+			throw;
+		}
+		return box<U>{ptr};
+	}
+
 	class value
 	{
 	public:
 		explicit value():m_value{}{}
 
 		template<class T>
-		requires(!is_object_or_array_v<T>)
+		requires(!is_boxed_v<T> && !is_string_like_v<T>)
 		explicit value(T&& val):m_value{std::forward<T>(val)}
 		{}
 
 		template<class T>
-		requires(is_object_or_array_v<T>)
-		explicit value(T&& val):m_value{std::make_unique<T>(std::forward<T>(val))}
+		requires(is_string_like_v<T>)
+		explicit value(T&& val):m_value{make_box(string{std::string_view{val}})}
+		{}
+
+		template<class T>
+		requires(is_boxed_v<T>)
+		explicit value(T&& val):m_value{make_box(std::forward<T>(val))}
 		{}
 
 		template<class T>
 		auto get_if() const
 		{
-			if constexpr(is_object_or_array_v<T>)
+			if constexpr(is_boxed_v<T>)
 			{
-				auto ptr = std::get_if<std::unique_ptr<T>>(&m_value);
-				return ptr != nullptr ? ptr->get() : nullptr;
+				auto ptr = std::get_if<box<T>>(&m_value);
+				return ptr != nullptr ? static_cast<T const*>(ptr->get()) : nullptr;
 			}
 			else
 			{ return std::get_if<T>(&m_value); }
@@ -148,31 +369,55 @@ namespace jopp
 		template<class T>
 		auto get_if()
 		{
-			if constexpr(is_object_or_array_v<T>)
+			if constexpr(is_boxed_v<T>)
 			{
-				auto ptr = std::get_if<std::unique_ptr<T>>(&m_value);
+				auto ptr = std::get_if<box<T>>(&m_value);
 				return ptr != nullptr ? ptr->get() : nullptr;
 			}
 			else
 			{ return std::get_if<T>(&m_value); }
 		}
 
+		// get<std::string_view> reads any string value, whether it is owned or refers to the input
 		template<class T>
-		auto& get() const
+		decltype(auto) get() const
 		{
-			auto res = get_if<T>();
-			if(res == nullptr)
-			{ throw field_type_mismatch_error{".", std::type_identity<T>{}}; }
-			return *res;
+			if constexpr(std::is_same_v<T, std::string_view>)
+			{
+				auto const res = to_string_view(*this);
+				if(!res.has_value())
+				{ throw field_type_mismatch_error{".", std::type_identity<string>{}}; }
+				return std::string_view{*res};
+			}
+			else
+			{
+				auto res = get_if<T>();
+				if(res == nullptr)
+				{ throw_type_mismatch<T>("."); }
+				return *res;
+			}
 		}
 
 		template<class T>
-		auto& get()
+		decltype(auto) get()
 		{
-			auto res = get_if<T>();
-			if(res == nullptr)
-			{ throw field_type_mismatch_error{".", std::type_identity<T>{}}; }
-			return *res;
+			if constexpr(std::is_same_v<T, std::string_view>)
+			{ return std::as_const(*this).template get<T>(); }
+			else
+			{
+				auto res = get_if<T>();
+				if(res == nullptr)
+				{ throw_type_mismatch<T>("."); }
+				return *res;
+			}
+		}
+
+		template<class T>
+		[[noreturn]] void throw_type_mismatch(std::string_view key) const
+		{
+			if(std::is_same_v<T, string> && std::holds_alternative<string_ref>(m_value))
+			{ throw field_type_mismatch_error::referenced_string(key); }
+			throw field_type_mismatch_error{key, std::type_identity<T>{}};
 		}
 
 		template<class Visitor, class ... Args>
@@ -205,17 +450,47 @@ namespace jopp
 			}, m_value);
 		}
 
-		bool operator==(value const&) const = default;
-		bool operator!=(value const&) const = default;
+		friend std::optional<std::string_view> to_string_view(value const& val)
+		{
+			if(auto str = val.get_if<string>(); str != nullptr)
+			{ return *str; }
+
+			if(auto str = val.get_if<string_ref>(); str != nullptr)
+			{ return str->view(); }
+
+			return std::nullopt;
+		}
+
+		bool operator==(value const& other) const
+		{
+			if(auto a = to_string_view(*this), b = to_string_view(other); a.has_value() && b.has_value())
+			{ return *a == *b; }
+
+			if(m_value.index() != other.m_value.index())
+			{ return false; }
+
+			return std::visit([&other]<class T>(T const& a){
+				auto const& b = *std::get_if<T>(&other.m_value);
+				if constexpr(std::is_same_v<T, box<string>>)
+				{ return *a == *b; }
+				else
+				{ return a == b; }
+			}, m_value);
+		}
+
+		bool operator!=(value const& other) const
+		{ return !(*this == other); }
 
 	private:
+		// Strings are stored out of line, so that every alternative fits in one pointer
 		std::variant<
 			null,
 			boolean,
-			std::unique_ptr<object>,
-			std::unique_ptr<array>,
+			box<object>,
+			box<array>,
 			number,
-			string
+			box<string>,
+			string_ref
 			> m_value;
 	};
 
@@ -224,14 +499,19 @@ namespace jopp
 
 	inline std::optional<value> make_value(std::string_view literal)
 	{
-		if(literal == false_literal)
-		{ return value{false}; }
+		switch(literal.empty() ? '\0' : literal.front())
+		{
+			case 'f':
+				return literal == false_literal ? std::optional{value{false}} : std::nullopt;
 
-		if(literal == true_literal)
-		{ return value{true}; }
+			case 't':
+				return literal == true_literal ? std::optional{value{true}} : std::nullopt;
 
-		if(literal == null_literal)
-		{ return value{null{}}; }
+			case 'n':
+				if(literal == null_literal)
+				{ return value{null{}}; }
+				break;
+		}
 
 		if(auto val = to_number(literal); val.has_value())
 		{ return value{*val}; }
@@ -250,9 +530,25 @@ namespace jopp
 	class object
 	{
 	public:
-		using key_type = std::string;
+		using key_type = string;
 		using mapped_type = value;
-		using value_type = std::pair<key_type const, mapped_type>;
+#if defined(JOPP_FLAT_OBJECTS)
+		using storage_type = flat_map<key_type, mapped_type>;
+#elif defined(JOPP_HASHED_OBJECTS)
+		using storage_type = hash_map<key_type, mapped_type>;
+#else
+		using storage_type = std::pmr::map<key_type, mapped_type, std::less<>>;
+#endif
+		using value_type = typename storage_type::value_type;
+		using allocator_type = std::pmr::polymorphic_allocator<value_type>;
+
+		object() = default;
+
+		explicit object(std::pmr::memory_resource* resource):m_values{resource}
+		{}
+
+		auto get_allocator() const
+		{ return m_values.get_allocator(); }
 
 		auto begin() const
 		{ return std::begin(m_values); }
@@ -275,37 +571,78 @@ namespace jopp
 		auto find(std::string_view key)
 		{ return m_values.find(key); }
 
+		// get_field_as<std::string_view> reads any string field, whether it is owned or refers to
+		// the input
 		template<class T>
-		auto& get_field_as(std::string_view key) const
+		decltype(auto) get_field_as(std::string_view key) const
 		{
 			auto const i = find(key);
 			if(i == std::end(m_values))
 			{ throw missing_field_error{key}; }
 
-			auto const value = i->second.get_if<T>();
-			if(value == nullptr)
-			{ throw field_type_mismatch_error{key, std::type_identity<T>{}}; }
-
-			return *value;
+			if constexpr(std::is_same_v<T, std::string_view>)
+			{
+				auto const str = to_string_view(i->second);
+				if(!str.has_value())
+				{ throw field_type_mismatch_error{key, std::type_identity<string>{}}; }
+				return std::string_view{*str};
+			}
+			else
+			{
+				auto const value = i->second.get_if<T>();
+				if(value == nullptr)
+				{ i->second.template throw_type_mismatch<T>(key); }
+				return *value;
+			}
 		}
 
+		// Like get_field_as, but a missing field, or a field of another type, is not an error.
+		// try_get_field_as<std::string_view> returns a std::optional<std::string_view>.
 		template<class T>
-		T const* try_get_field_as(std::string_view key) const
+		auto try_get_field_as(std::string_view key) const
 		{
 			auto const i = find(key);
-			if(i == std::end(m_values))
-			{ return nullptr; }
-
-			return i->second.get_if<T>();
+			if constexpr(std::is_same_v<T, std::string_view>)
+			{ return i != std::end(m_values) ? to_string_view(i->second) : std::optional<std::string_view>{}; }
+			else
+			{ return i != std::end(m_values) ? i->second.get_if<T>() : nullptr; }
 		}
 
-		template<class T>
-		auto insert(key_type&& key, T&& value)
-		{ return m_values.insert(std::pair{std::move(key), mapped_type{std::forward<T>(value)}}); }
+		template<class Key, class T>
+		requires(std::is_convertible_v<Key, std::string_view>)
+		auto insert(Key&& key, T&& value)
+		{ return m_values.insert(std::pair{make_key(std::forward<Key>(key)), mapped_type{std::forward<T>(value)}}); }
+
+		template<class Key, class T>
+		requires(std::is_convertible_v<Key, std::string_view>)
+		auto insert_or_assign(Key&& key, T&& value)
+		{ return m_values.insert_or_assign(make_key(std::forward<Key>(key)), mapped_type{std::forward<T>(value)}); }
+
+		// Unlike insert, this does not keep a flat object searchable, and a flat or hashed object
+		// does not look for the key. Call sort_fields when done. If the key already exists in an
+		// ordered object, value is left untouched.
+		template<class Key, class T>
+		requires(std::is_convertible_v<Key, std::string_view>)
+		bool append(Key&& key, T&& value)
+		{
+#if defined(JOPP_FLAT_OBJECTS) || defined(JOPP_HASHED_OBJECTS)
+			m_values.append(std::pair{make_key(std::forward<Key>(key)), mapped_type{std::forward<T>(value)}});
+			return true;
+#else
+			return m_values.try_emplace(make_key(std::forward<Key>(key)), std::forward<T>(value)).second;
+#endif
+		}
 
-		template<class T>
-		auto insert_or_assign(key_type&& key, T&& value)
-		{ return m_values.insert_or_assign(std::move(key), mapped_type{std::forward<T>(value)}); }
+		// Returns false if a key has been appended more than once. A hashed object iterates in
+		// insertion order until this is called.
+		bool sort_fields()
+		{
+#if defined(JOPP_FLAT_OBJECTS) || defined(JOPP_HASHED_OBJECTS)
+			return m_values.sort_unique();
+#else
+			return true;
+#endif
+		}
 
 		auto contains(std::string_view key) const
 		{ return m_values.contains(key); }
@@ -314,12 +651,31 @@ namespace jopp
 		{ return m_values.empty(); }
 
 	private:
-		std::map<key_type, mapped_type, std::less<>> m_values;
+		template<class Key>
+		key_type make_key(Key&& key) const
+		{
+			if constexpr(std::is_same_v<std::remove_cvref_t<Key>, key_type>)
+			{ return std::forward<Key>(key); }
+			else
+			{ return key_type{std::string_view{key}, m_values.get_allocator()}; }
+		}
+
+		storage_type m_values;
 	};
 
 	class array
 	{
 	public:
+		using allocator_type = std::pmr::polymorphic_allocator<value>;
+
+		array() = default;
+
+		explicit array(std::pmr::memory_resource* resource):m_values{resource}
+		{}
+
+		auto get_allocator() const
+		{ return m_values.get_allocator(); }
+
 		template<class T>
 		void push_back(T&& val)
 		{ m_values.push_back(value{std::forward<T>(val)}); }
@@ -349,17 +705,25 @@ namespace jopp
 		{ return m_values.empty(); }
 
 	private:
-		std::vector<value> m_values;
+		std::pmr::vector<value> m_values;
 	};
 
 	class item_pointer
 	{
 	public:
-		explicit item_pointer(std::pair<object::key_type const, object::mapped_type> const* kv):
+		template<class Key>
+		explicit item_pointer(std::pair<Key, value> const* kv):
 			m_key{safe_deref(kv).first},
 			m_value{&safe_deref(kv).second}
 		{}
 
+		// For the items of a flat or hashed object, which are returned by value
+		template<class Key>
+		explicit item_pointer(std::pair<Key const&, value const&> kv):
+			m_key{kv.first},
+			m_value{&kv.second}
+		{}
+
 		explicit item_pointer(value const* val):
 			m_key{},
 			m_value{val}
@@ -390,6 +754,20 @@ namespace jopp
 		explicit container(T&& val):m_value{std::forward<T>(val)}
 		{}
 
+		container(container&&) = default;
+
+		// Unlike the move assignment of the backing store, this keeps the memory resource of other
+		container& operator=(container&& other)
+		{
+			if(this != &other)
+			{
+				std::visit([this]<class T>(T&& val){
+					m_value.template emplace<std::remove_cvref_t<T>>(std::forward<T>(val));
+				}, std::move(other.m_value));
+			}
+			return *this;
+		}
+
 		template<class T>
 		auto get_if() const
 		{ return std::get_if<T>(&m_value); }
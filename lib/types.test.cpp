@@ -3,6 +3,10 @@
 #include "./types.hpp"
 
 #include <utility>
+#include <random>
+#include <cstring>
+#include <cmath>
+#include <limits>
 #include <testfwk/testfwk.hpp>
 
 TESTCASE(jopp_value_store_bool)
@@ -152,6 +156,21 @@ TESTCASE(jopp_value_store_string)
 	});
 }
 
+TESTCASE(jopp_value_is_compact)
+{
+	EXPECT_EQ(sizeof(jopp::value), 16);
+}
+
+TESTCASE(jopp_value_compare_strings)
+{
+	std::string const str{"A string that does not fit in the small string buffer"};
+	jopp::value a{str};
+	jopp::value b{std::string_view{str}};
+	EXPECT_EQ(a, b);
+	EXPECT_NE(a, jopp::value{"Hello, World"});
+	EXPECT_NE(a, jopp::value{1.0});
+}
+
 TESTCASE(jopp_value_default_is_null)
 {
 	jopp::value a{};
@@ -211,6 +230,41 @@ TESTCASE(jopp_to_number)
 	EXPECT_EQ(empty_string.has_value(), false);
 }
 
+TESTCASE(jopp_to_number_fast_path_matches_from_chars)
+{
+	auto const expect_same = [](std::string_view str) {
+		auto const res = jopp::to_number(str);
+		double expected{};
+		auto const from_chars_res = std::from_chars(std::begin(str), std::end(str), expected);
+		auto const valid = from_chars_res.ptr == std::end(str) && from_chars_res.ec == std::errc{};
+		REQUIRE_EQ(res.has_value(), valid);
+		if(valid)
+		{ EXPECT_EQ(std::memcmp(&*res, &expected, sizeof(expected)), 0); }
+	};
+
+	for(auto item : std::initializer_list<std::string_view>{
+		"0", "-0", "1", "-1", "0.1", "0.3", "-0.0", "00012", "1.", ".5", "1e", "1e+", "1e-5",
+		"1E22", "1e23", "123456789012345", "1234567890123456", "9007199254740993",
+		"0.000000000000000000000000001", "1.7976931348623157e308", "4.9e-324", "-",
+		"+1", "1.5e-22", "1.5e-23", "12345678901234567890", "1e1000", "1e-1000", "0x10"
+	})
+	{ expect_same(item); }
+
+	std::mt19937 rng;
+	for(size_t k = 0; k != 100000; ++k)
+	{
+		std::string str;
+		if(k % 2 == 0)
+		{ str += '-'; }
+		str.append(std::to_string(std::uniform_int_distribution<uint64_t>{0, 999999}(rng)));
+		str += '.';
+		str.append(std::to_string(std::uniform_int_distribution<uint64_t>{0, 99999999}(rng)));
+		if(k % 3 == 0)
+		{ str.append("e").append(std::to_string(std::uniform_int_distribution{-30, 30}(rng))); }
+		expect_same(str);
+	}
+}
+
 char const* (*test_to_string_null)(jopp::null) = jopp::to_string;
 
 TESTCASE(jopp_to_string_null)
@@ -253,6 +307,33 @@ TESTCASE(jopp_to_string_number)
 	EXPECT_EQ(val, "1.25");
 }
 
+TESTCASE(jopp_write_number_matches_to_chars)
+{
+	auto const expect_same = [](double val) {
+		std::array<char, jopp::max_number_size> expected;
+		auto const expected_end = std::to_chars(std::data(expected), std::data(expected) + std::size(expected), val).ptr;
+		std::array<char, jopp::max_number_size> buffer;
+		auto const end = jopp::write_number(std::data(buffer), val);
+		EXPECT_EQ((std::string_view{std::data(buffer), end}), (std::string_view{std::data(expected), expected_end}));
+	};
+
+	for(auto item : std::initializer_list<double>{
+		0.0, -0.0, 1.0, -1.0, 10.0, 1.25, 1e5, 1e6, -1e6, 1.2e6, 12e6, 123e7, 1e15, 9007199254740991.0,
+		9007199254740992.0, -9007199254740991.0, 1e22, 0.1, 1.7976931348623157e308, 4.9e-324,
+		std::numeric_limits<double>::infinity(), std::numeric_limits<double>::quiet_NaN()
+	})
+	{ expect_same(item); }
+
+	std::mt19937 rng;
+	for(size_t k = 0; k != 100000; ++k)
+	{
+		auto const digits = static_cast<double>(std::uniform_int_distribution<int64_t>{-99999, 99999}(rng));
+		auto const scale = std::pow(10.0, std::uniform_int_distribution{0, 12}(rng));
+		expect_same(digits*scale);
+		expect_same(static_cast<double>(std::uniform_int_distribution<int64_t>{-(int64_t{1} << 53), int64_t{1} << 53}(rng)));
+	}
+}
+
 TESTCASE(jopp_item_pointer_empty)
 {
 	jopp::item_pointer ptr{nullptr};
@@ -278,3 +359,65 @@ TESTCASE(jopp_item_pointer_value)
 	EXPECT_EQ(ptr.get_key(), std::string_view{});
 	EXPECT_EQ(ptr.get_value(), jopp::value{124.0});
 }
+
+namespace
+{
+	class counting_resource:public std::pmr::memory_resource
+	{
+	public:
+		size_t bytes_in_use{};
+		size_t allocation_count{};
+
+	private:
+		void* do_allocate(size_t bytes, size_t alignment) override
+		{
+			bytes_in_use += bytes;
+			++allocation_count;
+			return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+		}
+
+		void do_deallocate(void* ptr, size_t bytes, size_t alignment) override
+		{
+			bytes_in_use -= bytes;
+			std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+		}
+
+		bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override
+		{ return this == &other; }
+	};
+}
+
+TESTCASE(jopp_container_with_memory_resource)
+{
+	counting_resource resource;
+	{
+		jopp::object obj{&resource};
+		jopp::array vals{&resource};
+		vals.push_back(jopp::string{"A string that does not fit in the small string buffer", &resource});
+		vals.push_back(jopp::object{&resource});
+		obj.insert(jopp::string{"A key that does not fit in the small string buffer", &resource},
+			std::move(vals));
+		EXPECT_EQ(obj.get_allocator().resource(), &resource);
+		EXPECT_NE(resource.allocation_count, 0);
+
+		jopp::container root{std::move(obj)};
+		auto const count = resource.allocation_count;
+		root = jopp::container{jopp::array{&resource}};
+		EXPECT_EQ(resource.allocation_count, count);
+		REQUIRE_NE(root.get_if<jopp::array>(), nullptr);
+		EXPECT_EQ(root.get_if<jopp::array>()->get_allocator().resource(), &resource);
+	}
+	EXPECT_EQ(resource.bytes_in_use, 0);
+}
+
+TESTCASE(jopp_container_move_assign_keeps_resource)
+{
+	std::pmr::monotonic_buffer_resource resource;
+	jopp::container root;
+	jopp::object obj{&resource};
+	obj.insert("foo", 1.0);
+	root = jopp::container{std::move(obj)};
+	REQUIRE_NE(root.get_if<jopp::object>(), nullptr);
+	EXPECT_EQ(root.get_if<jopp::object>()->get_allocator().resource(), &resource);
+	EXPECT_EQ(root.get_if<jopp::object>()->get_field_as<jopp::number>("foo"), 1.0);
+}
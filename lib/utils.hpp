@@ -5,6 +5,9 @@
 #include <memory>
 #include <cassert>
 #include <array>
+#include <variant>
+#include <utility>
+#include <iterator>
 
 namespace jopp
 {
@@ -64,6 +67,50 @@ namespace jopp
 		std::unique_ptr<enumerator<ValueReference>> m_impl;
 	};
 
+	// Like range_processor, but the iterator type is one of InputIterators, so no heap allocation
+	// or virtual call is needed
+	template<class ValueReference, class ... InputIterators>
+	class static_range_processor
+	{
+	public:
+		static_range_processor() = default;
+
+		template<class InputIterator>
+		explicit static_range_processor(InputIterator begin, InputIterator end):
+			m_range{std::in_place_type<std::pair<InputIterator, InputIterator>>, begin, end}
+		{}
+
+		ValueReference pop_element()
+		{
+			return [this]<size_t ... I>(std::index_sequence<I...>) {
+				ValueReference ret{nullptr};
+				(void)((m_range.index() == I && (ret = pop_element(*std::get_if<I>(&m_range)), true)) || ...);
+				return ret;
+			}(std::index_sequence_for<InputIterators...>{});
+		}
+
+	private:
+		template<class InputIterator>
+		static ValueReference pop_element(std::pair<InputIterator, InputIterator>& range)
+		{
+			if(range.first == range.second)
+			{ return ValueReference{nullptr}; }
+
+			// Iterators that return proxies by value, like those of a flat object, give nothing
+			// to take the address of
+			auto ret = [&range](){
+				if constexpr(std::is_constructible_v<ValueReference, std::iter_reference_t<InputIterator>>)
+				{ return ValueReference{*range.first}; }
+				else
+				{ return ValueReference{&*range.first}; }
+			}();
+			++range.first;
+			return ret;
+		}
+
+		std::variant<std::pair<InputIterators, InputIterators>...> m_range;
+	};
+
 	template<class T>
 	requires(std::is_pointer_v<T>)
 	constexpr decltype(auto) safe_deref(T val)
@@ -4,6 +4,8 @@
 
 #include <testfwk/testfwk.hpp>
 
+#include <vector>
+
 TESTCASE(jopp_utils_iterator_enumerator_default_valref)
 {
 	std::array<int, 16> vals{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 15, 16};
@@ -71,3 +73,29 @@ TESTCASE(jopp_utils_range_processor_custom_valref)
 
 	EXPECT_EQ(count, std::size(vals));
 }
+
+TESTCASE(jopp_utils_static_range_processor_custom_valref)
+{
+	std::array<int, 16> vals{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 15, 16};
+	std::vector<int> other_vals{17, 18};
+	using processor = jopp::static_range_processor<my_valref, std::vector<int>::iterator, std::array<int, 16>::iterator>;
+	processor rangeproc{std::begin(vals), std::end(vals)};
+
+	size_t count = 0;
+
+	while(true)
+	{
+		auto const ref = rangeproc.pop_element();
+		if(ref.ptr == nullptr)
+		{ break; }
+		EXPECT_EQ(*ref.ptr, vals[count]);
+		++count;
+	}
+
+	EXPECT_EQ(count, std::size(vals));
+
+	rangeproc = processor{std::begin(other_vals), std::end(other_vals)};
+	EXPECT_EQ(*rangeproc.pop_element().ptr, 17);
+	EXPECT_EQ(*rangeproc.pop_element().ptr, 18);
+	EXPECT_EQ(rangeproc.pop_element().ptr, nullptr);
+}